@@ -0,0 +1,22 @@
+#version 120
+
+// Dual-filter blur, downsample pass: the target is half the size of the source
+
+uniform sampler2D texture;
+uniform vec2 texelSize; // 1 / source size
+uniform float offset;
+
+void main()
+{
+    vec2 texCoords = gl_TexCoord[0].xy;
+    vec2 d = texelSize * offset;
+
+    // Centre plus the four diagonal neighbours
+    vec4 color = texture2D(texture, texCoords) * 4.0;
+    color += texture2D(texture, texCoords - d);
+    color += texture2D(texture, texCoords + d);
+    color += texture2D(texture, texCoords + vec2(d.x, -d.y));
+    color += texture2D(texture, texCoords - vec2(d.x, -d.y));
+
+    gl_FragColor = color / 8.0;
+}
@@ -0,0 +1,26 @@
+#version 120
+
+// Dual-filter blur, upsample pass: the target is twice the size of the source
+
+uniform sampler2D texture;
+uniform vec2 texelSize; // 1 / source size
+uniform float offset;
+
+void main()
+{
+    vec2 texCoords = gl_TexCoord[0].xy;
+    vec2 d = texelSize * offset;
+
+    // Four points on the axes plus the four diagonals, weighted twice
+    vec4 color = texture2D(texture, texCoords + vec2(-d.x * 2.0, 0.0));
+    color += texture2D(texture, texCoords + vec2(d.x * 2.0, 0.0));
+    color += texture2D(texture, texCoords + vec2(0.0, -d.y * 2.0));
+    color += texture2D(texture, texCoords + vec2(0.0, d.y * 2.0));
+
+    color += texture2D(texture, texCoords + vec2(-d.x, d.y)) * 2.0;
+    color += texture2D(texture, texCoords + vec2(d.x, d.y)) * 2.0;
+    color += texture2D(texture, texCoords + vec2(d.x, -d.y)) * 2.0;
+    color += texture2D(texture, texCoords + vec2(-d.x, -d.y)) * 2.0;
+
+    gl_FragColor = color / 12.0;
+}
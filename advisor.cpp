@@ -0,0 +1,111 @@
+#include "advisor.hpp"
+
+// Marks that nothing has been asked, no composition key reaches this value
+const std::uint64_t NoRequest = ~std::uint64_t(0);
+
+// Same 5-bit packing as the solver's memo keys, with the upcard above the hand
+static std::uint64_t hintKey(const ValueCounts& hand, int upcard) {
+    std::uint64_t key = static_cast<std::uint64_t>(upcard) << 50;
+    for (int v = 0; v < ValueCount; ++v) {
+        key |= static_cast<std::uint64_t>(hand[v]) << (5 * v);
+    }
+    return key;
+}
+
+StrategyAdvisor::StrategyAdvisor(int decks, const RuleConfig& rules)
+    : decks(decks), rules(rules), stopping(false), hasJob(false), pending{}, cancel(false), thinking(false),
+      wantedKey(NoRequest), hintReady(false), readyHint{} {
+    worker = std::thread(&StrategyAdvisor::run, this);
+}
+
+StrategyAdvisor::~StrategyAdvisor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        cancel = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+bool StrategyAdvisor::request(const Hand& player, Card dealerUpcard) {
+    ValueCounts hand = handCounts(player);
+    int upcard = valueIndex(dealerUpcard);
+    std::uint64_t key = hintKey(hand, upcard);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (key == wantedKey) return false;
+    wantedKey = key;
+    hintReady = false;
+
+    auto cached = cache.find(key);
+    if (cached != cache.end()) {
+        readyHint = cached->second;
+        hintReady = true;
+        hasJob = false;
+        cancel = thinking.load();
+        return true;
+    }
+
+    // Whatever the worker is on is no longer wanted
+    pending = Job{ key, hand, upcard };
+    hasJob = true;
+    cancel = thinking.load();
+    thinking = true;
+    wake.notify_one();
+    return true;
+}
+
+bool StrategyAdvisor::takeHint(StrategyHint& hint) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hintReady) return false;
+    hint = readyHint;
+    hintReady = false;
+    return true;
+}
+
+void StrategyAdvisor::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    wantedKey = NoRequest;
+    hintReady = false;
+}
+
+bool StrategyAdvisor::isThinking() const {
+    return thinking;
+}
+
+void StrategyAdvisor::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || hasJob; });
+        if (stopping) return;
+
+        Job job = pending;
+        hasJob = false;
+        cancel = false;
+        lock.unlock();
+
+        // The solver works from a fresh shoe less the hand and the upcard, the lock is not held meanwhile
+        std::unique_ptr<StrategySolver>& solver = solvers[job.upcard];
+        if (!solver) {
+            solver.reset(new StrategySolver(shoeCounts(decks), job.upcard, rules));
+            solver->setCancelFlag(&cancel);
+        }
+        HandEv result = solver->evaluate(job.hand, false, false);
+        bool interrupted = solver->interrupted();
+        if (interrupted) {
+            solver.reset();
+        }
+
+        lock.lock();
+        if (!interrupted) {
+            StrategyHint hint{ result.ev[Hit], result.ev[Stand] };
+            cache[job.key] = hint;
+            if (job.key == wantedKey) {
+                readyHint = hint;
+                hintReady = true;
+            }
+        }
+        thinking = hasJob;
+    }
+}
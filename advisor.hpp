@@ -0,0 +1,73 @@
+#pragma once
+
+// Strategy hints for the hand in play. The EVs are worked out on a worker thread, so the render
+// loop only ever posts the hand it shows and picks up answers that are already finished.
+
+#include "strategy.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+struct StrategyHint {
+    double hitEv;
+    double standEv;
+};
+
+class StrategyAdvisor {
+public:
+    StrategyAdvisor(int decks, const RuleConfig& rules);
+    ~StrategyAdvisor();
+
+    StrategyAdvisor(const StrategyAdvisor&) = delete;
+    StrategyAdvisor& operator=(const StrategyAdvisor&) = delete;
+
+    // Ask about a hand against the dealer's upcard, true when it differs from the last one asked.
+    // Never waits: work on an older hand is cancelled, and a hand seen before is answered from the cache.
+    bool request(const Hand& player, Card dealerUpcard);
+
+    // Hand the answer for the last request over once, false while it is still being worked out
+    bool takeHint(StrategyHint& hint);
+
+    // Forget the last request, so asking about the same hand again delivers its answer again
+    void clear();
+
+    // A hand is being worked out, the caller should keep polling
+    bool isThinking() const;
+
+private:
+    struct Job {
+        std::uint64_t key;
+        ValueCounts hand;
+        int upcard;
+    };
+
+    void run();
+
+    const int decks;
+    const RuleConfig rules;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    bool hasJob;
+    Job pending;
+    std::atomic<bool> cancel;
+    std::atomic<bool> thinking;
+
+    // Hands answered so far, by composition and upcard
+    std::unordered_map<std::uint64_t, StrategyHint> cache;
+
+    // Wanted by the render loop, only touched under the mutex
+    std::uint64_t wantedKey;
+    bool hintReady;
+    StrategyHint readyHint;
+
+    // One solver per upcard, kept between hands so their memos carry over. Only the worker uses them.
+    std::array<std::unique_ptr<StrategySolver>, ValueCount> solvers;
+};
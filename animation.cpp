@@ -0,0 +1,97 @@
+#include "animation.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Animations step at 120 Hz whatever the frame rate
+const float AnimationStep = 1.0f / 120.0f;
+
+// After a long stall, catch up at most this many steps instead of freezing to replay them all
+const int MaxStepsPerUpdate = 8;
+
+float ease(Easing easing, float t) {
+    switch (easing) {
+    case EaseOutCubic: {
+        float u = 1 - t;
+        return 1 - u * u * u;
+    }
+    case EaseInOutCubic:
+        if (t < 0.5f) return 4 * t * t * t;
+        return 1 - std::pow(-2 * t + 2, 3.0f) / 2;
+    default:
+        return t;
+    }
+}
+
+float travelTime(const sf::Vector2f& from, const sf::Vector2f& to, float speed) {
+    sf::Vector2f distance = to - from;
+    return std::sqrt(distance.x * distance.x + distance.y * distance.y) / speed;
+}
+
+Animator::Animator() : accumulator(0) {
+    tweens.reserve(16);
+}
+
+void Animator::moveTo(sf::Transformable& object, const sf::Vector2f& to, float duration, float delay,
+    Easing easing, std::function<void()> onComplete) {
+    tweens.push_back(Tween{ &object, object.getPosition(), to, delay, duration, 0, easing, false, std::move(onComplete) });
+}
+
+void Animator::update(sf::Time frameTime) {
+    accumulator += frameTime.asSeconds();
+
+    int steps = 0;
+    while (accumulator >= AnimationStep && steps < MaxStepsPerUpdate) {
+        step(AnimationStep);
+        accumulator -= AnimationStep;
+        steps++;
+    }
+    if (steps == MaxStepsPerUpdate) {
+        accumulator = 0;
+    }
+}
+
+void Animator::step(float dt) {
+    for (size_t i = 0; i < tweens.size();) {
+        Tween& tween = tweens[i];
+
+        if (tween.delay > 0) {
+            tween.delay -= dt;
+            ++i;
+            continue;
+        }
+        if (!tween.started) {
+            tween.from = tween.object->getPosition();
+            tween.started = true;
+        }
+
+        tween.elapsed += dt;
+        float t = tween.duration > 0 ? std::min(tween.elapsed / tween.duration, 1.0f) : 1.0f;
+        tween.object->setPosition(tween.from + (tween.to - tween.from) * ease(tween.easing, t));
+
+        if (t < 1.0f) {
+            ++i;
+            continue;
+        }
+
+        // Done: keep the callback for later and fill the hole with the last tween
+        if (tween.onComplete) {
+            finished.push_back(std::move(tween.onComplete));
+        }
+        tween = std::move(tweens.back());
+        tweens.pop_back();
+    }
+
+    for (auto& callback : finished) {
+        callback();
+    }
+    finished.clear();
+}
+
+bool Animator::isAnimating() const {
+    return !tweens.empty();
+}
+
+void Animator::clear() {
+    tweens.clear();
+    accumulator = 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// Tween scheduler: every running animation lives in one contiguous array and is advanced in
+// fixed time steps by a single loop, independent of how often the scene is drawn.
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include <vector>
+
+enum Easing {
+    Linear,
+    EaseOutCubic,
+    EaseInOutCubic
+};
+
+// Eased progress for t in [0, 1]
+float ease(Easing easing, float t);
+
+// Seconds needed to cover the distance between two points at a constant speed
+float travelTime(const sf::Vector2f& from, const sf::Vector2f& to, float speed);
+
+// One object moving from where it stands to a target point
+struct Tween {
+    sf::Transformable* object;
+    sf::Vector2f from;
+    sf::Vector2f to;
+    float delay;    // Seconds left before the move starts, used for sequencing and staggering
+    float duration;
+    float elapsed;
+    Easing easing;
+    bool started;   // The start point is only taken once the delay runs out
+    std::function<void()> onComplete;
+};
+
+class Animator {
+public:
+    Animator();
+
+    // Move an object to a point. Chained moves can be queued with increasing delays,
+    // each one starts from wherever the object is when its delay runs out.
+    void moveTo(sf::Transformable& object, const sf::Vector2f& to, float duration, float delay = 0,
+        Easing easing = Linear, std::function<void()> onComplete = nullptr);
+
+    // Advance by the time since the last frame, in fixed steps
+    void update(sf::Time frameTime);
+
+    bool isAnimating() const;
+
+    // Drop every running tween without calling its completion callback
+    void clear();
+
+private:
+    void step(float dt);
+
+    std::vector<Tween> tweens;                    // Finished tweens are swapped out, so the array stays packed
+    std::vector<std::function<void()>> finished; // Callbacks run after the step, so they can queue new tweens
+    float accumulator;
+};
@@ -0,0 +1,229 @@
+#include "asset_bundle.hpp"
+#include "assets.hpp"
+#include "card_atlas.hpp"
+#include "scene.hpp"
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// The header is padded to one entry, and every asset starts on a 64-byte boundary
+const char BundleMagic[8] = { 'B', 'J', 'A', 'S', 'S', 'E', 'T', '1' };
+const size_t BundleHeaderSize = sizeof(BundleEntry);
+const size_t BundleAlignment = 64;
+
+// Size of a mip level the way GL counts them: halved and rounded down, never below one pixel
+static sf::Vector2u mipSize(unsigned width, unsigned height, unsigned level) {
+    return sf::Vector2u(std::max(1u, width >> level), std::max(1u, height >> level));
+}
+
+static unsigned mipLevelCount(unsigned width, unsigned height) {
+    unsigned levels = 1;
+    while ((width >> levels) > 0 || (height >> levels) > 0) ++levels;
+    return levels;
+}
+
+static size_t mipChainBytes(unsigned width, unsigned height, unsigned levels) {
+    size_t bytes = 0;
+    for (unsigned level = 0; level < levels; ++level) {
+        sf::Vector2u size = mipSize(width, height, level);
+        bytes += static_cast<size_t>(size.x) * size.y * 4;
+    }
+    return bytes;
+}
+
+AssetBundle::AssetBundle() : entries(nullptr), count(0) {
+}
+
+bool AssetBundle::open(const std::string& path) {
+    entries = nullptr;
+    count = 0;
+    if (!file.open(path, "asset bundle", MappedFile::WholeFileAccess)) {
+        return false;
+    }
+
+    const std::uint8_t* data = file.data();
+    size_t length = file.size();
+    std::uint32_t entrySize = 0, entryCount = 0;
+    if (length >= BundleHeaderSize) {
+        std::memcpy(&entrySize, data + sizeof(BundleMagic), sizeof(entrySize));
+        std::memcpy(&entryCount, data + sizeof(BundleMagic) + sizeof(entrySize), sizeof(entryCount));
+    }
+    bool valid = length >= BundleHeaderSize && std::memcmp(data, BundleMagic, sizeof(BundleMagic)) == 0
+        && entrySize == sizeof(BundleEntry) && entryCount <= (length - BundleHeaderSize) / sizeof(BundleEntry);
+
+    // Every asset has to lie inside the file, so a truncated bundle is caught here and not on upload
+    const BundleEntry* table = reinterpret_cast<const BundleEntry*>(data + BundleHeaderSize);
+    for (std::uint32_t i = 0; valid && i < entryCount; ++i) {
+        const BundleEntry& entry = table[i];
+        valid = entry.offset <= length && entry.size <= length - entry.offset
+            && std::memchr(entry.name, 0, sizeof(entry.name)) != nullptr
+            && (entry.kind != ImageAsset || (entry.levels > 0
+                && entry.size == mipChainBytes(entry.width, entry.height, entry.levels)));
+    }
+    if (!valid) {
+        std::cerr << "Error: " << path << " is not an asset bundle!" << std::endl;
+        file.release();
+        return false;
+    }
+
+    entries = table;
+    count = entryCount;
+    return true;
+}
+
+const BundleEntry* AssetBundle::find(const std::string& name) const {
+    for (size_t i = 0; i < count; ++i) {
+        if (name == entries[i].name) return &entries[i];
+    }
+    return nullptr;
+}
+
+bool AssetBundle::loadTexture(const std::string& name, sf::Texture& texture) const {
+    const BundleEntry* entry = find(name);
+    if (!entry || entry->kind != ImageAsset || !texture.create(entry->width, entry->height)) {
+        std::cerr << "Error loading " << name << " from the asset bundle!" << std::endl;
+        return false;
+    }
+
+    // The top level goes through SFML, the rest straight to GL from the mapping. SFML doesn't know the
+    // levels are there, which is why the texture can't be smoothed or updated afterwards: either would
+    // reset the filter.
+    const std::uint8_t* pixels = file.data() + entry->offset;
+    texture.setSmooth(true);
+    texture.update(pixels);
+
+    sf::Texture::bind(&texture);
+    for (unsigned level = 1; level < entry->levels; ++level) {
+        sf::Vector2u above = mipSize(entry->width, entry->height, level - 1);
+        pixels += static_cast<size_t>(above.x) * above.y * 4;
+        sf::Vector2u size = mipSize(entry->width, entry->height, level);
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+    if (entry->levels > 1) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    }
+    sf::Texture::bind(nullptr);
+    return true;
+}
+
+bool AssetBundle::loadFont(const std::string& name, sf::Font& font) const {
+    const BundleEntry* entry = find(name);
+    if (!entry || entry->kind != FontAsset || !font.loadFromMemory(file.data() + entry->offset, entry->size)) {
+        std::cerr << "Error loading " << name << " from the asset bundle!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// An asset on its way into the bundle
+struct PackedAsset {
+    BundleEntry entry;
+    std::vector<std::uint8_t> bytes;
+};
+
+static PackedAsset packedAsset(const std::string& name, BundleAssetKind kind) {
+    PackedAsset asset = {};
+    std::strncpy(asset.entry.name, name.c_str(), sizeof(asset.entry.name) - 1);
+    asset.entry.kind = kind;
+    return asset;
+}
+
+// The image and every level below it, each one averaged down from the full image so errors don't stack up
+static PackedAsset packImage(const std::string& name, const sf::Image& image) {
+    PackedAsset asset = packedAsset(name, ImageAsset);
+    sf::Vector2u size = image.getSize();
+    asset.entry.width = size.x;
+    asset.entry.height = size.y;
+    asset.entry.levels = mipLevelCount(size.x, size.y);
+
+    const sf::Uint8* top = image.getPixelsPtr();
+    asset.bytes.assign(top, top + static_cast<size_t>(size.x) * size.y * 4);
+    for (unsigned level = 1; level < asset.entry.levels; ++level) {
+        sf::Vector2u levelSize = mipSize(size.x, size.y, level);
+        sf::Image mip = downscaleImage(image, levelSize.x, levelSize.y);
+        const sf::Uint8* pixels = mip.getPixelsPtr();
+        asset.bytes.insert(asset.bytes.end(), pixels, pixels + static_cast<size_t>(levelSize.x) * levelSize.y * 4);
+    }
+    asset.entry.size = asset.bytes.size();
+    return asset;
+}
+
+int packAssetBundle(const std::string& path) {
+    std::vector<PackedAsset> assets;
+
+    sf::Image cards = CardAtlas::bakeImage(CardScale);
+    if (cards.getSize().x == 0) {
+        return -1;
+    }
+    assets.push_back(packImage(CardAtlasAsset, cards));
+
+    sf::Image background;
+    if (!background.loadFromFile(BackgroundPath)) {
+        std::cerr << "Error loading image: " << BackgroundPath << std::endl;
+        return -1;
+    }
+    sf::Vector2u backgroundSize = background.getSize();
+    // It's stretched over the virtual table, so it's baked no larger than that
+    if (backgroundSize.x > VirtualSize.x || backgroundSize.y > VirtualSize.y) {
+        background = downscaleImage(background, std::min(backgroundSize.x, VirtualSize.x),
+            std::min(backgroundSize.y, VirtualSize.y));
+    }
+    assets.push_back(packImage(BackgroundPath, background));
+
+    std::ifstream fontFile(TableFontPath, std::ios::binary);
+    if (!fontFile) {
+        std::cerr << "Error loading font: " << TableFontPath << std::endl;
+        return -1;
+    }
+    PackedAsset font = packedAsset(TableFontPath, FontAsset);
+    font.bytes.assign(std::istreambuf_iterator<char>(fontFile), std::istreambuf_iterator<char>());
+    font.entry.size = font.bytes.size();
+    assets.push_back(font);
+
+    // Lay the assets out after the table of contents
+    size_t offset = BundleHeaderSize + assets.size() * sizeof(BundleEntry);
+    for (auto& asset : assets) {
+        offset = (offset + BundleAlignment - 1) / BundleAlignment * BundleAlignment;
+        asset.entry.offset = offset;
+        offset += asset.bytes.size();
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error writing " << path << "!" << std::endl;
+        return -1;
+    }
+    std::uint8_t header[BundleHeaderSize] = {};
+    std::uint32_t entrySize = sizeof(BundleEntry);
+    std::uint32_t entryCount = static_cast<std::uint32_t>(assets.size());
+    std::memcpy(header, BundleMagic, sizeof(BundleMagic));
+    std::memcpy(header + sizeof(BundleMagic), &entrySize, sizeof(entrySize));
+    std::memcpy(header + sizeof(BundleMagic) + sizeof(entrySize), &entryCount, sizeof(entryCount));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (const auto& asset : assets) {
+        out.write(reinterpret_cast<const char*>(&asset.entry), sizeof(asset.entry));
+    }
+    for (const auto& asset : assets) {
+        std::vector<char> padding(static_cast<size_t>(asset.entry.offset - out.tellp()), 0);
+        out.write(padding.data(), padding.size());
+        out.write(reinterpret_cast<const char*>(asset.bytes.data()), asset.bytes.size());
+    }
+    if (!out) {
+        std::cerr << "Error writing " << path << "!" << std::endl;
+        return -1;
+    }
+
+    for (const auto& asset : assets) {
+        std::cout << asset.entry.name;
+        if (asset.entry.kind == ImageAsset) {
+            std::cout << " " << asset.entry.width << "x" << asset.entry.height << ", " << asset.entry.levels << " levels";
+        }
+        std::cout << ", " << asset.entry.size / 1024 << " KB" << std::endl;
+    }
+    std::cout << "Packed " << assets.size() << " assets into " << path << " (" << offset / (1024 * 1024) << " MB)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// One file holding every asset the table needs, baked offline by --pack-assets. Images are stored as raw
+// RGBA at the size they are drawn, followed by their mip levels, and fonts as the font file itself. At
+// startup the bundle is mapped and uploaded straight from the mapping, with no image decoding at all.
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include "mapped_file.hpp"
+
+// Bundle looked for next to the game
+const char* const DefaultBundlePath = "assets.bundle";
+
+// Loose files the bundle is baked from, their paths double as names in the bundle
+const char* const TableFontPath = "fonts/PlayfairDisplay-Bold.ttf";
+const char* const BackgroundPath = "images/backgroundImage.jpg";
+const char* const CardAtlasAsset = "cards"; // Every card face and the back in the card atlas layout
+
+enum BundleAssetKind {
+    ImageAsset = 1,
+    FontAsset
+};
+
+// One asset in the bundle's table of contents
+struct BundleEntry {
+    char name[32];           // Zero-terminated
+    std::uint32_t kind;      // BundleAssetKind
+    std::uint32_t width;     // Images only, size of the top mip level
+    std::uint32_t height;
+    std::uint32_t levels;    // Images only, mip levels stored one after the other
+    std::uint64_t offset;    // From the start of the file
+    std::uint64_t size;
+};
+
+static_assert(sizeof(BundleEntry) == 64, "BundleEntry is part of the file format");
+
+class AssetBundle {
+public:
+    AssetBundle();
+
+    bool open(const std::string& path);
+
+    // Null when the bundle has no asset by that name
+    const BundleEntry* find(const std::string& name) const;
+
+    // Upload an image with all its stored mip levels, sampled with trilinear filtering.
+    // Needs an active GL context, and the texture must not be smoothed or updated afterwards.
+    bool loadTexture(const std::string& name, sf::Texture& texture) const;
+
+    // The font reads the mapping in place, so the bundle has to outlive it
+    bool loadFont(const std::string& name, sf::Font& font) const;
+
+private:
+    MappedFile file;
+    const BundleEntry* entries;
+    size_t count;
+};
+
+// Bake the card atlas, the background and the table font into a bundle at the given path
+int packAssetBundle(const std::string& path);
@@ -0,0 +1,71 @@
+#include "assets.hpp"
+#include <algorithm>
+#include <iostream>
+
+DecodedImage decodeImageAsync(const std::string& path, const sf::Vector2u& maxSize) {
+    return std::async(std::launch::async, [path, maxSize] {
+        sf::Image image;
+        if (!image.loadFromFile(path)) {
+            std::cerr << "Error loading image: " << path << std::endl;
+            return image;
+        }
+
+        sf::Vector2u size = image.getSize();
+        if (maxSize.x > 0 && maxSize.y > 0 && (size.x > maxSize.x || size.y > maxSize.y)) {
+            double fit = std::min(static_cast<double>(maxSize.x) / size.x, static_cast<double>(maxSize.y) / size.y);
+            image = downscaleImage(image, std::max(1u, static_cast<unsigned>(size.x * fit)),
+                std::max(1u, static_cast<unsigned>(size.y * fit)));
+        }
+        return image;
+    });
+}
+
+sf::Image downscaleImage(const sf::Image& source, unsigned width, unsigned height) {
+    sf::Vector2u sourceSize = source.getSize();
+    const sf::Uint8* pixels = source.getPixelsPtr();
+
+    std::vector<sf::Uint8> result(static_cast<size_t>(width) * height * 4);
+    for (unsigned y = 0; y < height; ++y) {
+        // Rows of the source that fall inside this destination row
+        unsigned y0 = y * sourceSize.y / height;
+        unsigned y1 = std::max(y0 + 1, (y + 1) * sourceSize.y / height);
+
+        for (unsigned x = 0; x < width; ++x) {
+            unsigned x0 = x * sourceSize.x / width;
+            unsigned x1 = std::max(x0 + 1, (x + 1) * sourceSize.x / width);
+
+            unsigned sum[4] = { 0, 0, 0, 0 };
+            for (unsigned sy = y0; sy < y1; ++sy) {
+                const sf::Uint8* row = pixels + (static_cast<size_t>(sy) * sourceSize.x + x0) * 4;
+                for (unsigned sx = x0; sx < x1; ++sx, row += 4) {
+                    sum[0] += row[0];
+                    sum[1] += row[1];
+                    sum[2] += row[2];
+                    sum[3] += row[3];
+                }
+            }
+
+            unsigned count = (x1 - x0) * (y1 - y0);
+            sf::Uint8* out = &result[(static_cast<size_t>(y) * width + x) * 4];
+            for (int c = 0; c < 4; ++c) {
+                out[c] = static_cast<sf::Uint8>(sum[c] / count);
+            }
+        }
+    }
+
+    sf::Image image;
+    image.create(width, height, result.data());
+    return image;
+}
+
+StartupTimer::StartupTimer() : start(std::chrono::steady_clock::now()), last(start) {
+}
+
+void StartupTimer::mark(const std::string& phase) {
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> phaseTime = now - last;
+    std::chrono::duration<double, std::milli> totalTime = now - start;
+    last = now;
+
+    std::cout << "Startup: " << phase << " " << phaseTime.count() << " ms (" << totalTime.count() << " ms total)" << std::endl;
+}
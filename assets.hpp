@@ -0,0 +1,31 @@
+#pragma once
+
+// Helpers for getting assets off the disk without holding up the first frame
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <future>
+#include <string>
+
+// Decoded pixels, or an empty image if the file could not be read
+using DecodedImage = std::future<sf::Image>;
+
+// Decode an image file on a worker thread, only the texture upload is left for the GL thread.
+// An image larger than a non-zero maximum size is shrunk to fit inside it, keeping its shape.
+DecodedImage decodeImageAsync(const std::string& path, const sf::Vector2u& maxSize = sf::Vector2u());
+
+// Shrink an image with an area average, so heavily downscaled art does not alias
+sf::Image downscaleImage(const sf::Image& source, unsigned width, unsigned height);
+
+// Logs how long each startup phase took and the total so far, for tracking time-to-first-frame
+class StartupTimer {
+public:
+    StartupTimer();
+
+    // Log the time since the previous mark under the given phase name
+    void mark(const std::string& phase);
+
+private:
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point last;
+};
@@ -0,0 +1,360 @@
+// Microbenchmarks for the game code, built as its own executable next to the game.
+//
+//   benchmark [--filter <text>] [--save <file>] [--baseline <file>] [--no-render]
+//
+// Each benchmark is calibrated to about 20 ms per sample and sampled repeatedly. The median time per
+// operation is reported with the median absolute deviation as the spread, next to the heap allocations
+// per operation. --save records the results, --baseline prints the change against recorded ones.
+
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "asset_bundle.hpp"
+#include "card_atlas.hpp"
+#include "engine.hpp"
+#include "hand_batch.hpp"
+#include "rules.hpp"
+#include "scene.hpp"
+#include "table.hpp"
+#include "ui.hpp"
+
+// Every heap allocation in the process goes through here, so a benchmark can count its own
+static std::atomic<long long> allocationCount(0);
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+using BenchClock = std::chrono::steady_clock;
+
+const int SampleCount = 15;
+const double SampleSeconds = 0.02;
+
+// Keep the compiler from dropping a result nobody reads
+template <typename T>
+inline void keep(const T& value) {
+#if defined(_MSC_VER)
+    static volatile const void* sink;
+    sink = &value;
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+struct BenchmarkResult {
+    std::string name;
+    double nsPerOp;
+    double spread;      // Median absolute deviation, as a fraction of nsPerOp
+    double allocsPerOp;
+    long long iterations;
+};
+
+// Time one operation: find an iteration count that fills a sample, then take the median of the samples
+static BenchmarkResult measure(const std::string& name, const std::function<void()>& operation) {
+    auto runFor = [&](long long iterations) {
+        auto start = BenchClock::now();
+        for (long long i = 0; i < iterations; ++i) operation();
+        return std::chrono::duration<double>(BenchClock::now() - start).count();
+    };
+
+    // Warm up, then double the count until one sample is long enough to time
+    long long iterations = 1;
+    while (true) {
+        double seconds = runFor(iterations);
+        if (seconds >= SampleSeconds / 4) {
+            iterations = std::max(1LL, static_cast<long long>(iterations * SampleSeconds / seconds));
+            break;
+        }
+        iterations *= 2;
+    }
+
+    // Reserved up front, so the samples' own storage isn't counted against the operation
+    std::vector<double> samples;
+    samples.reserve(SampleCount);
+    long long allocationsBefore = allocationCount.load();
+    for (int s = 0; s < SampleCount; ++s) {
+        samples.push_back(runFor(iterations) * 1e9 / iterations);
+    }
+    long long allocations = allocationCount.load() - allocationsBefore;
+
+    std::sort(samples.begin(), samples.end());
+    double median = samples[SampleCount / 2];
+    std::vector<double> deviations;
+    for (double sample : samples) deviations.push_back(std::abs(sample - median));
+    std::sort(deviations.begin(), deviations.end());
+
+    return BenchmarkResult{ name, median, deviations[SampleCount / 2] / median,
+        static_cast<double>(allocations) / (static_cast<double>(iterations) * SampleCount), iterations };
+}
+
+// Results saved by an earlier run, by name
+static std::map<std::string, BenchmarkResult> loadResults(const std::string& path) {
+    std::map<std::string, BenchmarkResult> results;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        BenchmarkResult result{ line.substr(0, tab), 0, 0, 0, 0 };
+        std::istringstream fields(line.substr(tab + 1));
+        if (fields >> result.nsPerOp >> result.spread >> result.allocsPerOp >> result.iterations) {
+            results[result.name] = result;
+        }
+    }
+    return results;
+}
+
+static bool saveResults(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error writing " << path << "!" << std::endl;
+        return false;
+    }
+    for (const auto& result : results) {
+        out << result.name << '\t' << result.nsPerOp << ' ' << result.spread << ' ' << result.allocsPerOp << ' '
+            << result.iterations << '\n';
+    }
+    return true;
+}
+
+// Everything the off-screen render benchmark draws with, loaded the way the window loads it
+struct RenderBench {
+    sf::Font font;
+    sf::Texture background;
+    CardAtlas atlas;
+    sf::RenderTexture target;
+    std::unique_ptr<TableUi> ui;
+
+    bool setUp(const sf::Vector2u& size) {
+        if (!font.loadFromFile(TableFontPath) || !background.loadFromFile(BackgroundPath)) {
+            std::cerr << "Error loading assets, run from the game directory!" << std::endl;
+            return false;
+        }
+        if (!target.create(size.x, size.y)) {
+            std::cerr << "Error creating render texture!" << std::endl;
+            return false;
+        }
+        atlas.startLoading(CardScale);
+        atlas.finishLoading();
+        ui = std::make_unique<TableUi>(font);
+        ui->setBackground(background);
+        ui->layout(size);
+        return true;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::string filter, savePath, baselinePath;
+    bool render = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) filter = argv[++i];
+        else if (arg == "--save" && hasValue) savePath = argv[++i];
+        else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+        else if (arg == "--no-render") render = false;
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <text>] [--save <file>] [--baseline <file>] [--no-render]"
+                << std::endl;
+            return -1;
+        }
+    }
+
+#ifndef _WIN32
+    // The render benchmark is meant for software GL, so results don't depend on the machine's GPU.
+    // Mesa honours this, an explicit setting in the environment wins.
+    setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+#endif
+
+    std::vector<std::pair<std::string, std::function<void()>>> benchmarks;
+    auto add = [&](const std::string& name, const std::function<void()>& operation) {
+        if (name.find(filter) != std::string::npos) benchmarks.emplace_back(name, operation);
+    };
+
+    // Cards for the hand benchmarks come from a shuffled 8-deck shoe, read round-robin
+    Rng rng(1);
+    ShoeConfig bigShoe{ MaxDecks, 1.0 };
+    Shoe source(bigShoe);
+    source.shuffle(rng);
+    std::vector<Card> cards;
+    while (!source.empty()) cards.push_back(source.deal());
+    size_t nextCard = 0;
+    auto drawCard = [&]() {
+        Card card = cards[nextCard];
+        nextCard = nextCard + 1 == cards.size() ? 0 : nextCard + 1;
+        return card;
+    };
+
+    add("hand value (5 cards)", [&]() {
+        Hand hand;
+        for (int i = 0; i < 5; ++i) hand.add(drawCard());
+        keep(hand.total());
+    });
+
+    // Hands of 1-8 cards scored as one batch by each kernel the CPU runs. A kernel has to agree with
+    // Hand on every hand before its timing is worth anything.
+    const int BatchHands = 4096;
+    std::vector<Hand> batchHands(BatchHands);
+    HandBatch batch;
+    for (auto& hand : batchHands) {
+        int size = 1 + static_cast<int>(rng() % 8);
+        for (int i = 0; i < size; ++i) hand.add(drawCard());
+        batch.add(hand);
+    }
+    SimdLevel bestLevel = detectSimdLevel();
+    std::cout << "Hand batch kernel: " << simdLevelName(bestLevel) << std::endl;
+    for (int level = ScalarLevel; level <= bestLevel; ++level) {
+        SimdLevel simd = static_cast<SimdLevel>(level);
+        batch.evaluate(simd);
+        for (int i = 0; i < BatchHands; ++i) {
+            const Hand& hand = batchHands[i];
+            if (batch.total(i) != hand.total() || batch.isSoft(i) != hand.isSoft() || batch.isBust(i) != hand.isBust()) {
+                std::cerr << "Error: " << simdLevelName(simd) << " batch kernel scores hand " << i << " as "
+                    << batch.total(i) << ", Hand says " << hand.total() << "!" << std::endl;
+                return -1;
+            }
+        }
+        add(std::string("hand batch ") + simdLevelName(simd) + " (4096)", [&batch, simd]() {
+            batch.evaluate(simd);
+            keep(batch.total(0));
+        });
+    }
+
+    // Fixed pairs of hands, so the winner benchmarks only time the comparison
+    std::vector<std::pair<Hand, Hand>> rounds(256);
+    for (auto& round : rounds) {
+        for (int i = 0; i < 2 + static_cast<int>(rng() % 2); ++i) round.first.add(drawCard());
+        for (int i = 0; i < 2 + static_cast<int>(rng() % 2); ++i) round.second.add(drawCard());
+    }
+    size_t nextRound = 0;
+
+    add("determineOutcome", [&]() {
+        const auto& round = rounds[nextRound++ % rounds.size()];
+        keep(determineOutcome(round.first.total(), round.second.total()));
+    });
+
+    add("determineWinner", [&]() {
+        const auto& round = rounds[nextRound++ % rounds.size()];
+        std::string winner = determineWinner(round.first, round.second);
+        keep(winner.size());
+    });
+
+    ShoeConfig shoeConfig{ 6, 0.75 };
+    add("shoe create (6 decks)", [&]() {
+        Shoe shoe(shoeConfig);
+        keep(shoe.remaining());
+    });
+
+    Shoe shoe(shoeConfig);
+    add("shoe shuffle (6 decks)", [&]() {
+        shoe.shuffle(rng);
+        keep(shoe.remaining());
+    });
+
+    // A round has to be finished before the next deal, so the stand is timed with it
+    Table table(shoeConfig, RuleConfig(), 1);
+    std::vector<sf::Vector2f> dealerPositions, playerPositions;
+    sf::Vector2u windowSize = VirtualSize;
+    add("resetGame + stand", [&]() {
+        resetGame(table, dealerPositions, playerPositions, windowSize);
+        table.stand();
+        keep(table.result().payout);
+    });
+
+    add("adjustCardPositions", [&]() {
+        const auto& round = rounds[nextRound++ % rounds.size()];
+        adjustCardPositions(dealerPositions, playerPositions, round.first, round.second, windowSize);
+        keep(playerPositions.back());
+    });
+
+    // The headless round with the default rules, doubles and splits included
+    Shoe roundShoe(shoeConfig);
+    roundShoe.shuffle(rng);
+    std::function<RoundResult()> playOneRound = dispatchRules(RuleConfig(), [&](auto rules) {
+        using R = decltype(rules);
+        return std::function<RoundResult()>([&roundShoe, &rng]() { return playRound<R>(roundShoe, rng); });
+    });
+    add("full hand simulation", [&]() {
+        if (roundShoe.needsShuffle()) roundShoe.shuffle(rng);
+        keep(playOneRound().payout);
+    });
+
+    // The GameStart scene with a round in play, drawn off-screen. glFinish waits for the frame to be
+    // rendered, not just queued.
+    RenderBench renderBench;
+    sf::VertexArray cardVertices(sf::Quads);
+    sf::Transformable cardTop;
+    if (render && std::string("render GameStart scene").find(filter) != std::string::npos && renderBench.setUp(windowSize)) {
+        cardTop.setPosition(windowSize.x / 2.0f + 500, windowSize.y / 2.0f - 150);
+        resetGame(table, dealerPositions, playerPositions, windowSize);
+        renderBench.ui->setSums(table.dealerHand().total(), table.playerHand().total());
+
+        std::cout << "Renderer: " << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << std::endl;
+        add("render GameStart scene", [&]() {
+            drawGameScene(renderBench.target, *renderBench.ui, renderBench.atlas, cardVertices,
+                table.dealerHand(), table.playerHand(), dealerPositions, playerPositions, cardTop, false);
+            renderBench.target.display();
+            glFinish();
+        });
+    }
+
+    std::map<std::string, BenchmarkResult> baseline;
+    if (!baselinePath.empty()) {
+        baseline = loadResults(baselinePath);
+        if (baseline.empty()) {
+            std::cerr << "Error: no results in " << baselinePath << "!" << std::endl;
+            return -1;
+        }
+    }
+
+    std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(14) << "ns/op"
+        << std::setw(9) << "+-" << std::setw(14) << "allocs/op";
+    if (!baseline.empty()) std::cout << std::setw(12) << "vs base";
+    std::cout << std::endl;
+
+    std::vector<BenchmarkResult> results;
+    for (const auto& benchmark : benchmarks) {
+        BenchmarkResult result = measure(benchmark.first, benchmark.second);
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(28) << result.name << std::right << std::fixed
+            << std::setw(14) << std::setprecision(1) << result.nsPerOp
+            << std::setw(8) << std::setprecision(1) << 100.0 * result.spread << "%"
+            << std::setw(14) << std::setprecision(2) << result.allocsPerOp;
+        auto recorded = baseline.find(result.name);
+        if (recorded != baseline.end()) {
+            std::cout << std::setw(11) << std::showpos << std::setprecision(1)
+                << 100.0 * (result.nsPerOp / recorded->second.nsPerOp - 1.0) << "%" << std::noshowpos;
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    if (!savePath.empty() && !saveResults(savePath, results)) {
+        return -1;
+    }
+    return 0;
+}
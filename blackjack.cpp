@@ -2,12 +2,36 @@
 #include <SFML/Audio.hpp>
 #include <cmath>
 #include <iostream>
+#include <fstream>
 #include <vector>
-#include <unordered_map>
 #include <string>
-#include <memory> // For std::shared_ptr
-#include <random>
+#include <cstdint>
+#include <ctime>
 #include <algorithm>
+#include <stdexcept>
+#include <array>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include "advisor.hpp"
+#include "animation.hpp"
+#include "asset_bundle.hpp"
+#include "assets.hpp"
+#include "blur.hpp"
+#include "card_atlas.hpp"
+#include "engine.hpp"
+#include "frame_limiter.hpp"
+#include "hand_log.hpp"
+#include "profiler.hpp"
+#include "profiler_hud.hpp"
+#include "scene.hpp"
+#include "ui.hpp"
+#include "server.hpp"
+#include "simulate.hpp"
+#include "sound_effects.hpp"
+#include "strategy.hpp"
+#include "table.hpp"
+#include "texture_cache.hpp"
 
 enum GameState {
     StartScreen,
@@ -15,372 +39,263 @@ enum GameState {
     GameStart
 };
 
-// Card class to represent individual cards
-class Card {
-public:
-    std::string rank;
-    std::string suit;
-    int value;
-    std::shared_ptr<sf::Texture> texture;
-    sf::Sprite sprite;
-
-    Card(const std::string& rank, const std::string& suit, int value, std::shared_ptr<sf::Texture> texture)
-        : rank(rank), suit(suit), value(value), texture(texture) {
-        if (texture) {
-            sprite.setTexture(*texture);
-            sprite.setScale(0.15f, 0.15f); // Adjust for table layout
-        }
-    }
+// Upper bound on the frame rate while something moves, a still table isn't redrawn at all
+const unsigned int MaxFrameRate = 120;
 
-    void setPosition(const sf::Vector2f& position) {
-        sprite.setPosition(position);
-    }
+// Halvings used to blur the table behind the pause menu
+const int PauseBlurRadius = 4;
 
-    void draw(sf::RenderWindow& window) const {
-        window.draw(sprite);
-    }
-};
+// Seconds between the moves of a replayed round
+const float ReplayStepDelay = 0.6f;
 
-// Function to preload textures
-std::unordered_map<std::string, std::shared_ptr< sf::Texture> > preloadTextures() {
-    std::unordered_map<std::string, std::shared_ptr< sf::Texture> > textures;
-    std::string faces[] = { "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A" };
-    std::string suits[] = { "S", "H", "D", "C" };
+// Range of --render-scale: a quarter of the window's pixels up to supersampling
+const float MinRenderScale = 0.25f;
+const float MaxRenderScale = 2.0f;
 
-    for (const auto& suit : suits) {
-        for (const auto& face : faces) {
-            std::string texturePath = "images/" + face + suit + ".png";
-            auto texture = std::make_shared<sf::Texture>();
-            if (!texture->loadFromFile(texturePath)) {
-                std::cerr << "Error loading texture: " << texturePath << std::endl;
-            }
-            else {
-                textures[face + suit] = texture;
-            }
-        }
-    }
-    return textures;
-}
+// Seconds of profile a trace dump covers
+const double TraceSeconds = 10.0;
 
-// Function to create and shuffle the deck
-std::vector<Card> createDeck(const std::unordered_map<std::string, std::shared_ptr< sf::Texture> >& textures) {
-    std::vector<Card> deck;
-    std::string faces[] = { "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A" };
-    std::string suits[] = { "S", "H", "D", "C" };
-    int values[] = { 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10, 11 };
+// Table skins T cycles through, null is the plain felt
+const std::array<const char*, 4> TableSkins = {
+    nullptr, "images/background.jpg", "images/background_image.jpg", "images/start_screen_background.jpg"
+};
 
-    for (const auto& suit : suits) {
-        for (int i = 0; i < 13; ++i) {
-            std::string key = faces[i] + suit;
-            if (textures.find(key) != textures.end()) {
-                deck.emplace_back(faces[i], suit, values[i], textures.at(key));
-            }
-            else {
-                std::cerr << "Texture not found for card: " << key << std::endl;
-            }
+// Skins are shrunk to the virtual table size, and at most two of them stay in video memory
+const size_t SkinBudgetBytes = 2 * VirtualSize.x * VirtualSize.y * 4;
+
+// Function to queue the opening deal, each card leaves the deck once the one before it has landed
+void startDealAnimation(Animator& animator, std::array<sf::Transformable, InitialDealSize>& dealtCards,
+    const std::array<sf::Vector2f, InitialDealSize>& dealTargets, const sf::Vector2f& deckPosition,
+    float speed, const std::function<void()>& onLanded, const std::function<void()>& onFinished) {
+    float delay = 0;
+    for (size_t i = 0; i < dealtCards.size(); ++i) {
+        dealtCards[i].setPosition(deckPosition);
+        float duration = travelTime(deckPosition, dealTargets[i], speed);
+        std::function<void()> landed = onLanded;
+        if (i + 1 == dealtCards.size()) {
+            landed = [onLanded, onFinished]() {
+                onLanded();
+                onFinished();
+            };
         }
+        animator.moveTo(dealtCards[i], dealTargets[i], duration, delay, EaseOutCubic, landed);
+        delay += duration;
     }
-
-    // Shuffle the deck
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(deck.begin(), deck.end(), g);
-
-    return deck;
 }
 
-// Function to calculate the total value of a hand
-int calculateHandValue(const std::vector<Card>& hand) {
-    int value = 0, aceCount = 0;
-
-    for (const auto& card : hand) {
-        value += card.value;
-        if (card.rank == "A") aceCount++;
-    }
-
-    while (value > 21 && aceCount > 0) {
-        value -= 10; // Convert Ace from 11 to 1
-        aceCount--;
-    }
+// Function to pick the sound that announces how a round ended
+SoundEffect resultSound(const RoundResult& result, const Hand& playerCards) {
+    if (playerCards.isBust()) return BustSound;
+    if (result.outcome == PlayerWins) return WinSound;
+    if (result.outcome == DealerWins) return LoseSound;
+    return PushSound;
+}
 
-    return value;
+// Function to word a strategy hint, e.g. "Hit -0.409  Stand -0.476"
+std::string hintMessage(const StrategyHint& hint) {
+    std::ostringstream message;
+    message << std::fixed << std::setprecision(3) << "Hit " << hint.hitEv << "  Stand " << hint.standEv;
+    return message.str();
 }
 
-// Function to determine the winner
-std::string determineWinner(const std::vector<Card>& dealerHand, const std::vector<Card>& playerHand) {
-    int dealerValue = calculateHandValue(dealerHand);
-    int playerValue = calculateHandValue(playerHand);
+// Function to pick the buttons that take input in the current state
+UiLayer activeLayer(GameState currentGameState, bool paused, bool gameOver) {
+    if (paused) return PauseLayer;
+    if (currentGameState == StartScreen) return StartLayer;
+    return gameOver ? RoundOverLayer : PlayLayer;
+}
 
-    if (playerValue > 21) return "Dealer Wins!";
-    if (dealerValue > 21) return "Player Wins!";
-    if (playerValue > dealerValue) return "Player Wins!";
-    if (dealerValue > playerValue) return "Dealer Wins!";
-    return "It's a Tie!";
+// Function to draw the pause menu over the blurred frame captured when the game was paused
+void drawPauseMenu(sf::RenderTarget& target, const TableUi& ui, const sf::Texture& blurredScene) {
+    // The blur is as many pixels as the scene is rendered at, stretched back over the virtual table
+    sf::Sprite background(blurredScene);
+    background.setScale(static_cast<float>(VirtualSize.x) / blurredScene.getSize().x,
+        static_cast<float>(VirtualSize.y) / blurredScene.getSize().y);
+    target.draw(background);
+    ui.drawPauseMenu(target);
 }
 
-// Adjust card positioning for dealer and player
-void adjustCardPositions(std::vector<Card>& dealerCards, std::vector<Card>& playerCards, const sf::Vector2u& windowSize) {
-    float cardSpacing = 100; // Space between cards
+// Settings taken from the command line
+struct LaunchOptions {
+    ShoeConfig shoe;
+    RuleConfig rules;
+    long long simulateHands = 0; // Run headless instead of opening the window when positive
+    std::string strategyPath;    // Solve and export the basic-strategy chart instead of playing
+    std::string serveAddress;    // Run the headless table server on this socket
+    std::string botsAddress;     // Load a running server with bots instead of playing
+    int tables = 1000;           // Most tables served, or tables the bots play
+    int seconds = 10;            // How long the bots play
+    std::string logPath;         // Append every finished round to this hand log
+    std::string analyzePath;     // Print statistics for a hand log instead of playing
+    std::string replayPath;      // Play back the rounds of a hand log instead of dealing
+    long long replayHand = 0;    // First round to play back
+    std::string packPath;        // Bake the asset bundle instead of playing
+    std::string bundlePath = DefaultBundlePath; // Assets come from here when it exists, loose files otherwise
+    float renderScale = 1.0f;    // Scene pixels per window pixel, below 1 for weak GPUs
+    std::uint64_t seed = 0;
+    bool seeded = false;         // Replay a given seed instead of drawing a fresh one
+};
 
-    // Dealer cards centered
-    float dealerX = (windowSize.x - dealerCards.size() * cardSpacing) / 2.0f;
-    float dealerY = windowSize.y * 0.15f;
+// Function to read the command line options
+bool parseArguments(int argc, char* argv[], LaunchOptions& options) {
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
 
-    // Player cards centered
-    float playerX = (windowSize.x - playerCards.size() * cardSpacing) / 2.0f;
-    float playerY = windowSize.y * 0.55f;
+            if (arg == "--strategy" && hasValue) {
+                options.strategyPath = argv[++i];
+            }
+            else if (arg == "--serve" && hasValue) {
+                options.serveAddress = argv[++i];
+            }
+            else if (arg == "--bots" && hasValue) {
+                options.botsAddress = argv[++i];
+            }
+            else if (arg == "--tables" && hasValue) {
+                options.tables = std::stoi(argv[++i]);
+                if (options.tables <= 0) throw std::invalid_argument(arg);
+            }
+            else if (arg == "--seconds" && hasValue) {
+                options.seconds = std::stoi(argv[++i]);
+                if (options.seconds <= 0) throw std::invalid_argument(arg);
+            }
+            else if (arg == "--log" && hasValue) {
+                options.logPath = argv[++i];
+            }
+            else if (arg == "--analyze" && hasValue) {
+                options.analyzePath = argv[++i];
+            }
+            else if (arg == "--replay" && hasValue) {
+                options.replayPath = argv[++i];
+            }
+            else if (arg == "--hand" && hasValue) {
+                options.replayHand = std::stoll(argv[++i]);
+                if (options.replayHand < 0) throw std::invalid_argument(arg);
+            }
+            else if (arg == "--pack-assets" && hasValue) {
+                options.packPath = argv[++i];
+            }
+            else if (arg == "--bundle" && hasValue) {
+                options.bundlePath = argv[++i];
+            }
+            else if (arg == "--render-scale" && hasValue) {
+                options.renderScale = std::stof(argv[++i]);
+                if (options.renderScale < MinRenderScale || options.renderScale > MaxRenderScale) throw std::invalid_argument(arg);
+            }
+            else if (arg == "--simulate" && hasValue) {
+                options.simulateHands = std::stoll(argv[++i]);
+                if (options.simulateHands <= 0) throw std::invalid_argument(arg);
+            }
+            else if (arg == "--decks" && hasValue) {
+                options.shoe.decks = std::stoi(argv[++i]);
+                if (options.shoe.decks < MinDecks || options.shoe.decks > MaxDecks) throw std::invalid_argument(arg);
+            }
+            else if (arg == "--penetration" && hasValue) {
+                options.shoe.penetration = std::stod(argv[++i]);
+                if (options.shoe.penetration <= 0.0 || options.shoe.penetration > 1.0) throw std::invalid_argument(arg);
+            }
+            else if (arg == "--h17") {
+                options.rules.dealerHitsSoft17 = true;
+            }
+            else if (arg == "--no-das") {
+                options.rules.doubleAfterSplit = false;
+            }
+            else if (arg == "--surrender") {
+                options.rules.surrender = true;
+            }
+            else if (arg == "--payout" && hasValue) {
+                if (!parsePayout(argv[++i], options.rules.payout)) throw std::invalid_argument(arg);
+            }
+            else if (arg == "--seed" && hasValue) {
+                options.seed = std::stoull(argv[++i]);
+                options.seeded = true;
+            }
+            else {
+                throw std::invalid_argument(arg);
+            }
+        }
 
-    for (size_t i = 0; i < dealerCards.size(); ++i) {
-        dealerCards[i].setPosition(sf::Vector2f(dealerX + i * cardSpacing, dealerY));
+        // Checked once the deck count is known, the cut card has to leave the opening deal behind it
+        if (!isPlayablePenetration(options.shoe)) throw std::invalid_argument("--penetration");
     }
-    for (size_t i = 0; i < playerCards.size(); ++i) {
-        playerCards[i].setPosition(sf::Vector2f(playerX + i * cardSpacing, playerY));
+    catch (const std::exception&) {
+        std::cerr << "Usage: " << argv[0]
+            << " [--decks 1-8] [--penetration 0-1] [--h17] [--no-das] [--surrender] [--payout 3:2|6:5|1:1]"
+            << " [--seed <n>] [--simulate <hands>] [--strategy <file>]"
+            << " [--serve <socket>|tcp:<port>] [--bots <socket>|tcp:<port>] [--tables <n>] [--seconds <n>]"
+            << " [--log <file>] [--analyze <file>] [--replay <file> [--hand <n>]]"
+            << " [--pack-assets <file>] [--bundle <file>] [--render-scale 0.25-2]" << std::endl;
+        return false;
     }
+    return true;
 }
 
-// Function to draw the main Blackjack table
-void drawTable(sf::RenderWindow& window, sf::Font& font, const sf::Vector2u& windowSize,
-    const std::vector<Card>& dealerCards, const std::vector<Card>& playerCards) {
-    sf::RectangleShape table(sf::Vector2f(windowSize.x, windowSize.y));
-    table.setFillColor(sf::Color(0, 96, 100)); // Green table
-    window.draw(table);
-
-    sf::RectangleShape dealerZone(sf::Vector2f(windowSize.x * 0.9f, windowSize.y * 0.1f));
-    dealerZone.setFillColor(sf::Color(0, 0, 0, 50)); // Semi-transparent black
-    dealerZone.setPosition(windowSize.x * 0.05f, windowSize.y * 0.05f);
-    window.draw(dealerZone);
-
-    sf::RectangleShape playerZone(sf::Vector2f(windowSize.x * 0.9f, windowSize.y * 0.1f));
-    playerZone.setFillColor(sf::Color(0, 0, 0, 50)); // Semi-transparent black
-    playerZone.setPosition(windowSize.x * 0.05f, windowSize.y * 0.85f);
-    window.draw(playerZone);
-
-    // Dealer label
-    sf::Text dealerText("DEALER", font, 40);
-    dealerText.setFillColor(sf::Color::White);
-    dealerText.setPosition(windowSize.x * 0.45f, windowSize.y * 0.055f);
-    window.draw(dealerText);
-
-    // Dealer card sum
-    sf::Text dealerCardSum("Sum: " + std::to_string(calculateHandValue(dealerCards)), font, 50);
-    dealerCardSum.setFillColor(sf::Color::White);
-    dealerCardSum.setPosition(windowSize.x * 0.05f, windowSize.y * 0.16f); // Slightly below dealer zone
-    window.draw(dealerCardSum);
-
-    // Player label
-    sf::Text playerText("PLAYER", font, 40);
-    playerText.setFillColor(sf::Color::White);
-    playerText.setPosition(windowSize.x * 0.45f, windowSize.y * 0.86f);
-    window.draw(playerText);
-
-    // Player card sum
-    sf::Text playerCardSum("Sum: " + std::to_string(calculateHandValue(playerCards)), font, 50);
-    playerCardSum.setFillColor(sf::Color::White);
-    playerCardSum.setPosition(windowSize.x * 0.05f, windowSize.y * 0.77f); // Above player zone
-    window.draw(playerCardSum);
-}
-
-// Function to draw buttons
-void drawButtons(sf::RenderWindow& window, sf::Font& font, bool gameOver, const sf::Vector2u& windowSize) {
-    sf::Vector2f buttonSize(windowSize.x * 0.1f, windowSize.y * 0.08f);
-    float buttonY = windowSize.y * 0.7f; // Vertical position for buttons
-
-    // Adjust horizontal offset
-    float leftOffset = windowSize.x * 0.2f; // Distance from the left side of the screen
-    float spacing = windowSize.x * 0.02f;   // Spacing between buttons
-
-    if (!gameOver) {
-        // "Hit" button
-        sf::RectangleShape hitButton(buttonSize);
-        hitButton.setFillColor(sf::Color(0, 255, 0));
-        hitButton.setPosition(leftOffset, buttonY);
-        window.draw(hitButton);
-
-        sf::Text hitText("Hit", font, 40);
-        hitText.setFillColor(sf::Color::Black);
-        hitText.setPosition(hitButton.getPosition().x + (buttonSize.x - hitText.getLocalBounds().width) / 2,
-            hitButton.getPosition().y + (buttonSize.y - hitText.getLocalBounds().height) / 2 - 10);
-        window.draw(hitText);
-
-        // "Stand" button
-        sf::RectangleShape standButton(buttonSize);
-        standButton.setFillColor(sf::Color(255, 0, 0));
-        standButton.setPosition(leftOffset + buttonSize.x + spacing, buttonY);
-        window.draw(standButton);
-
-        sf::Text standText("Stand", font, 40);
-        standText.setFillColor(sf::Color::Black);
-        standText.setPosition(standButton.getPosition().x + (buttonSize.x - standText.getLocalBounds().width) / 2,
-            standButton.getPosition().y + (buttonSize.y - standText.getLocalBounds().height) / 2 - 10);
-        window.draw(standText);
+int main(int argc, char* argv[]) {
+    LaunchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return -1;
     }
-    else {
-        // "Restart" button
-        sf::RectangleShape restartButton(buttonSize);
-        restartButton.setFillColor(sf::Color(255, 255, 0));
-        restartButton.setPosition(leftOffset, buttonY);
-        window.draw(restartButton);
-
-        sf::Text restartText("Restart", font, 40);
-        restartText.setFillColor(sf::Color::Black);
-        restartText.setPosition(restartButton.getPosition().x + (buttonSize.x - restartText.getLocalBounds().width) / 2,
-            restartButton.getPosition().y + (buttonSize.y - restartText.getLocalBounds().height) / 2 - 10);
-        window.draw(restartText);
+    if (!options.seeded) {
+        options.seed = randomSeed();
     }
-}
 
-// Function to reset the game state
-void resetGame(std::vector<Card>& dealerCards, std::vector<Card>& playerCards, std::vector<Card>& deck,
-    const std::unordered_map<std::string, std::shared_ptr< sf::Texture> >& textures, const sf::Vector2u& windowSize) {
-    dealerCards.clear();
-    playerCards.clear();
-
-    deck = createDeck(textures);
-
-    // Deal initial cards
-    dealerCards.push_back(deck.back());
-    deck.pop_back();
-    dealerCards.push_back(deck.back());
-    deck.pop_back();
-    playerCards.push_back(deck.back());
-    deck.pop_back();
-    playerCards.push_back(deck.back());
-    deck.pop_back();
-
-    adjustCardPositions(dealerCards, playerCards, windowSize);
-}
-
-void resetGameState(GameState& currentGameState, sf::Sprite& initialPlayerCard1,
-                    sf::Sprite& initialPlayerCard2, sf::Sprite& initialDealerCard1, sf::Sprite& initialDealerCard2,
-                    bool& PlayerCard1Finished, bool& PlayerCard2Finished, bool& DealerCard1Finished, bool& DealerCard2Finished, sf::Vector2f& initialPosition){
-
-                        initialPlayerCard1.setPosition(initialPosition);
-                        initialPlayerCard2.setPosition(initialPosition);
-                        initialDealerCard1.setPosition(initialPosition);
-                        initialDealerCard2.setPosition(initialPosition);
-                        
-
-                        PlayerCard1Finished = false;
-                        PlayerCard2Finished = false;
-                        DealerCard1Finished = false;
-                        DealerCard2Finished = false;
-
-                        currentGameState = GettingCards;
-}
-
-void resetHitCard(sf::Sprite& hitCard, bool& HitCardFinished, const sf::Vector2f& initialPosition, bool& hit){
-    hitCard.setPosition(initialPosition);
-
-    HitCardFinished = false;
-    hit = false;
-}
-void hitGetACard(sf::RenderWindow& window, sf::Font& font, const sf::Vector2u& windowSize,
-    sf::Shader& blurShader, sf::RenderTexture& blurRenderTexture, const sf::Texture& gameScreenTexture, 
-    const std::vector<Card>& dealerCards, const std::vector<Card>& playerCards, bool& gameOver, sf::Sprite& cardTop, sf::RectangleShape pauseButton, sf::Text pauseText,
-    sf::Sprite& hitCard, bool& HitCardFinished, const sf::Vector2f& initialPosition, bool& hit, const sf::Vector2f& TargetHitCardPosition, float speed, float deltaSeconds) {
-    // Draw the game texture to the blur render texture with the shader
-    blurRenderTexture.clear();
-    blurRenderTexture.draw(sf::Sprite(gameScreenTexture));
-    blurRenderTexture.display();
-
-    // Draw the blurred texture to the window
-    sf::Sprite blurredSprite(blurRenderTexture.getTexture());
-    sf::RenderStates states;
-    states.shader = &blurShader;
-
-    window.draw(blurredSprite, states);
-
-    drawTable(window, font, windowSize, dealerCards, playerCards);
-
-    for (const auto& card : dealerCards) card.draw(window);
-    for (const auto& card : playerCards) card.draw(window);
-
-    sf::Vector2f currentPosition = hitCard.getPosition();
-    sf::Vector2f direction = TargetHitCardPosition - currentPosition;
-    float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-    if (length > 0){
-        direction.x /= length;
-        direction.y /= length;
+    // Headless mode: play hands without opening a window
+    if (options.simulateHands > 0) {
+        return runSimulation(options.simulateHands, options.shoe, options.rules, options.seed);
     }
-    if (length > speed * deltaSeconds){
-        hitCard.move(direction * speed * deltaSeconds);
-    } else {
-        hitCard.setPosition(TargetHitCardPosition);
-        resetHitCard(hitCard, HitCardFinished, initialPosition, hit);
+    if (!options.strategyPath.empty()) {
+        return exportStrategy(options.shoe, options.rules, options.strategyPath);
+    }
+    if (!options.serveAddress.empty()) {
+        return runServer(options.serveAddress, options.tables, options.shoe, options.rules, options.seed, options.logPath);
+    }
+    if (!options.botsAddress.empty()) {
+        return runLoadTest(options.botsAddress, options.tables, options.seconds);
+    }
+    if (!options.analyzePath.empty()) {
+        return analyzeHandLog(options.analyzePath);
+    }
+    if (!options.packPath.empty()) {
+        return packAssetBundle(options.packPath);
     }
 
-    window.draw(cardTop);
-    window.draw(pauseButton);
-    window.draw(pauseText);
-
-    drawButtons(window, font, gameOver, windowSize);
-}
-// Function to draw the pause menu with blurred background
-void drawPauseMenu(sf::RenderWindow& window, sf::Font& font, const sf::Vector2u& windowSize,
-    sf::Shader& blurShader, sf::RenderTexture& blurRenderTexture, const sf::Texture& gameScreenTexture, 
-    const std::vector<Card>& dealerCards, const std::vector<Card>& playerCards, bool& gameOver, sf::Sprite& cardTop) {
-    // Draw the game texture to the blur render texture with the shader
-    blurRenderTexture.clear();
-    blurRenderTexture.draw(sf::Sprite(gameScreenTexture));
-    blurRenderTexture.display();
-
-    // Draw the blurred texture to the window
-    sf::Sprite blurredSprite(blurRenderTexture.getTexture());
-    sf::RenderStates states;
-    states.shader = &blurShader;
-
-    window.draw(blurredSprite, states);
-
-    drawTable(window, font, windowSize, dealerCards, playerCards);
-
-    for (const auto& card : dealerCards) card.draw(window);
-    for (const auto& card : playerCards) card.draw(window);
-
-    window.draw(cardTop);
-
-    drawButtons(window, font, gameOver, windowSize);
-
-    sf::RectangleShape overlay(sf::Vector2f(windowSize.x, windowSize.y));
-    overlay.setFillColor(sf::Color(0, 0, 0, 200));
-    window.draw(overlay);
-
-    // Pause text
-    sf::Text pauseText("Paused", font, 50);
-    pauseText.setFillColor(sf::Color::White);
-    pauseText.setStyle(sf::Text::Bold);
-    pauseText.setPosition((windowSize.x - pauseText.getLocalBounds().width) / 2,
-        (windowSize.y - pauseText.getLocalBounds().height) / 2 - 100);
-    window.draw(pauseText);
-
-    // Resume button
-    sf::RectangleShape resumeButton(sf::Vector2f(200, 50));
-    resumeButton.setFillColor(sf::Color(100, 200, 100));
-    resumeButton.setPosition((windowSize.x - 200) / 2, (windowSize.y - 50) / 2 - 30);
-    window.draw(resumeButton);
-
-    sf::Text resumeText("Resume", font, 30);
-    resumeText.setFillColor(sf::Color::Black);
-    resumeText.setPosition(resumeButton.getPosition().x + (200 - resumeText.getLocalBounds().width) / 2,
-        resumeButton.getPosition().y + (50 - resumeText.getLocalBounds().height) / 2 - 5);
-    window.draw(resumeText);
-
-    // Quit button
-    sf::RectangleShape quitButton(sf::Vector2f(200, 50));
-    quitButton.setFillColor(sf::Color(200, 100, 100));
-    quitButton.setPosition((windowSize.x - 200) / 2, (windowSize.y - 50) / 2 + 50);
-    window.draw(quitButton);
-
-    sf::Text quitText("Quit", font, 30);
-    quitText.setFillColor(sf::Color::Black);
-    quitText.setPosition(quitButton.getPosition().x + (200 - quitText.getLocalBounds().width) / 2,
-        quitButton.getPosition().y + (50 - quitText.getLocalBounds().height) / 2 - 5);
-    window.draw(quitText);
-}
+    // Recorded rounds are dealt from the log instead of the shoe, and their moves play themselves
+    HandLogReader replayLog;
+    bool replaying = !options.replayPath.empty();
+    if (replaying && !replayLog.open(options.replayPath)) {
+        return -1;
+    }
+    if (replaying && static_cast<size_t>(options.replayHand) >= replayLog.size()) {
+        std::cerr << "Error: " << options.replayPath << " holds " << replayLog.size() << " hands!" << std::endl;
+        return -1;
+    }
+    size_t replayIndex = static_cast<size_t>(options.replayHand);
+
+    StartupTimer startupTimer;
+
+    // A baked bundle is mapped now and uploaded once the window's context exists. Without one, card
+    // faces and the start screen background decode on worker threads while the window comes up, and
+    // the start screen only waits for its own background.
+    AssetBundle bundle;
+    bool bundled = std::ifstream(options.bundlePath).good() && bundle.open(options.bundlePath);
+    CardAtlas atlas;
+    DecodedImage backgroundImage;
+    if (!bundled) {
+        atlas.startLoading(CardScale);
+        backgroundImage = decodeImageAsync(BackgroundPath);
+    }
+    if (bundled) {
+        startupTimer.mark("bundle");
+    }
 
-int main() {
-    sf::RenderWindow window(sf::VideoMode(1920, 1080), "Blackjack Game");
-    window.setFramerateLimit(60);
+    sf::VideoMode desktop = sf::VideoMode::getDesktopMode();
+    sf::Vector2u windowSize = initialWindowSize(sf::Vector2u(desktop.width, desktop.height));
+    sf::RenderWindow window(sf::VideoMode(windowSize.x, windowSize.y), "Blackjack Game");
+    // Frames are paced by vsync, with a sleeping limiter as the fallback where vsync is off
+    window.setVerticalSyncEnabled(true);
+    FrameLimiter frameLimiter(MaxFrameRate);
+    startupTimer.mark("window");
 
     GameState currentGameState = StartScreen;
 
@@ -395,423 +310,528 @@ int main() {
         backgroundMusic.setLoop(true); // Loop the music
         backgroundMusic.setVolume(50); // Adjust volume (0 to 100)
     }
+    startupTimer.mark("music");
+
+    // Effects are all decoded here, so playing one during a frame only hands a buffer to a voice
+    SoundEffects sounds;
+    sounds.load();
+    startupTimer.mark("sound effects");
 
     // Load font
     sf::Font font;
-    if (!font.loadFromFile("fonts/PlayfairDisplay-Bold.ttf")) {
+    if (bundled ? !bundle.loadFont(TableFontPath, font) : !font.loadFromFile(TableFontPath)) {
         std::cerr << "Error loading font!" << std::endl;
         return -1;
     }
-
-    // Load poker back
-    sf::Texture cardsback;
-    if(!cardsback.loadFromFile("images/BackColor_Red.png")){
-        std::cerr << "Error loading poker back image!" << std::endl;
-    }
+    startupTimer.mark("font");
 
     // Load background image
     sf::Texture backgroundTexture;
-    if (!backgroundTexture.loadFromFile("images/backgroundImage.jpg")) {
+    if (bundled ? !bundle.loadTexture(BackgroundPath, backgroundTexture) : !backgroundTexture.loadFromImage(backgroundImage.get())) {
         std::cerr << "Error loading background image!" << std::endl;
         return -1;
     }
+    startupTimer.mark("background");
 
-    // Preload textures using shared_ptr
-    auto textures = preloadTextures();
-    auto deck = createDeck(textures);
-    std::vector<Card> dealerCards, playerCards;
-    sf::Sprite cardTop(cardsback), initialDealerCard1(cardsback),
-    initialDealerCard2(cardsback), initialPlayerCard1(cardsback),
-    initialPlayerCard2(cardsback), hitCard(cardsback);
+    if (bundled) {
+        if (!atlas.loadFromBundle(bundle)) {
+            std::cerr << "Error loading card atlas!" << std::endl;
+            return -1;
+        }
+        startupTimer.mark("cards");
+    }
 
-    cardTop.setScale(0.15f, 0.15f), initialDealerCard1.setScale(0.15f, 0.15f),
-    initialDealerCard2.setScale(0.15f, 0.15f), initialPlayerCard1.setScale(0.15f, 0.15f),
-    initialPlayerCard2.setScale(0.15f, 0.15f), hitCard.setScale(0.15f, 0.15f);
+    // Every card face and the back end up in one texture, cards themselves only carry an id into it
+    sf::VertexArray cardVertices(sf::Quads);
+
+    // Every shuffle of the session follows from this seed, rerun with --seed to replay it
+    std::cout << "Shuffle seed: " << options.seed << std::endl;
+    std::cout << "Rules: " << describeRules(options.rules) << std::endl;
+    // Shoe, hands and rules all live in the table, the window only shows it
+    HandLogWriter handLog;
+    Table table(options.shoe, options.rules, options.seed);
+    if (!options.logPath.empty() && !replaying) {
+        if (!handLog.open(options.logPath)) {
+            return -1;
+        }
+        table.setLog(&handLog);
+    }
+    const Hand& dealerCards = table.dealerHand();
+    const Hand& playerCards = table.playerHand();
+    std::vector<sf::Vector2f> dealerPositions, playerPositions;
+    // Face-down cards on their way to the table, drawn from the atlas back cell
+    sf::Transformable cardTop, hitCard;
+    // The opening deal: two cards to the player, then two to the dealer
+    std::array<sf::Transformable, InitialDealSize> dealtCards;
 
     // Initialize game state
     bool playerTurn = true, gameOver = false, paused = false, hit = false;
     std::string resultMessage;
-    bool hoverEffect = false;
-    cardTop.setPosition(window.getSize().x / 2 + 500, window.getSize().y / 2 - 150);
-    hitCard.setPosition(window.getSize().x / 2 + 500, window.getSize().y / 2 - 150);
-    initialPlayerCard1.setPosition(window.getSize().x / 2 + 500, window.getSize().y / 2 - 150);
-    initialPlayerCard2.setPosition(window.getSize().x / 2 + 500, window.getSize().y / 2 - 150);
-    initialDealerCard1.setPosition(window.getSize().x / 2 + 500, window.getSize().y / 2 - 150);
-    initialDealerCard2.setPosition(window.getSize().x / 2 + 500, window.getSize().y / 2 - 150);
 
-    sf::Vector2f initialPosition(window.getSize().x / 2 + 500, window.getSize().y / 2 - 150);
+    // Everything below is in virtual coordinates, whatever the size of the window
+    sf::Vector2f initialPosition(VirtualSize.x / 2.0f + 500, VirtualSize.y / 2.0f - 150);
+    cardTop.setPosition(initialPosition);
+    hitCard.setPosition(initialPosition);
+    for (auto& card : dealtCards) {
+        card.setPosition(initialPosition);
+    }
 
-    sf::Vector2f TargetInitialPlayerCard1Position(window.getSize().x / 2, 1080);
-    sf::Vector2f TargetInitialPlayerCard2Position(window.getSize().x / 2, 1080);
-    sf::Vector2f TargetInitialDealerCard1Position(window.getSize().x / 2, -500);
-    sf::Vector2f TargetInitialDealerCard2Position(window.getSize().x / 2, -500);
+    const std::array<sf::Vector2f, InitialDealSize> dealTargets = {
+        sf::Vector2f(VirtualSize.x / 2.0f, static_cast<float>(VirtualSize.y)),
+        sf::Vector2f(VirtualSize.x / 2.0f, static_cast<float>(VirtualSize.y)),
+        sf::Vector2f(VirtualSize.x / 2.0f, -500),
+        sf::Vector2f(VirtualSize.x / 2.0f, -500)
+    };
 
-    sf::Vector2f TargetHitCardPosition(window.getSize().x / 2, 1080);
+    sf::Vector2f TargetHitCardPosition(VirtualSize.x / 2.0f, static_cast<float>(VirtualSize.y));
 
     float speed = 2500.0f;
     sf::Clock clock;
 
-    bool PlayerCard1Finished = false;
-    bool PlayerCard2Finished = false;
-    bool DealerCard1Finished = false;
-    bool DealerCard2Finished = false;
-
-    bool HitCardFinished = false;
-
-    // draw Pause button
-    sf::RectangleShape pauseButton(sf::Vector2f(100, 50));
-    pauseButton.setFillColor(sf::Color(100, 100, 100, 200));
-    pauseButton.setPosition(window.getSize().x - 120, 20);
-    sf::Text pauseText("Pause", font, 30);
-    pauseText.setFillColor(sf::Color::White);
-    pauseText.setPosition(pauseButton.getPosition().x + 10, pauseButton.getPosition().y + 5);
-
-    // Load blur shader
-    sf::Shader blurShader;
-    if (!blurShader.loadFromFile("shaders/blur.frag", sf::Shader::Fragment)) {
-        std::cerr << "Error loading blur shader!" << std::endl;
+    // Every card movement runs through here, stepped at a fixed rate once per frame
+    Animator animator;
+    bool buttonLocked = false;
+
+    // The round is dealt for real once the last card of the opening deal lands
+    std::function<void()> finishDeal = [&]() {
+        buttonLocked = false;
+        if (replaying) {
+            const HandRecord& record = replayLog[replayIndex];
+            std::cout << "Replaying hand " << replayIndex << " of " << replayLog.size() << ": seed " << record.seed
+                << ", table " << record.stream << ", round " << record.round << std::endl;
+            // The dealer has to play by the rules of the recording, or the stacked cards run out under other ones
+            RuleConfig recordedRules;
+            if (unpackRules(record, recordedRules)) {
+                if (describeRules(recordedRules) != describeRules(table.ruleConfig())) {
+                    std::cout << "Rules: " << describeRules(recordedRules) << std::endl;
+                }
+                table.setRules(recordedRules);
+            }
+            else {
+                std::cout << "Hand " << replayIndex << " was logged without its rules, replaying under "
+                    << describeRules(table.ruleConfig()) << std::endl;
+            }
+            table.stackCards(dealOrder(record));
+        }
+        resetGame(table, dealerPositions, playerPositions, VirtualSize);
+        currentGameState = GameStart;
+
+        // A blackjack on either side settles the round on the spot
+        if (table.state() == RoundOver) {
+            resultMessage = outcomeMessage(table.result().outcome);
+            gameOver = true;
+            sounds.play(FlipSound);
+            sounds.play(resultSound(table.result(), playerCards));
+        }
+    };
+    std::function<void()> cardLanded = [&]() {
+        sounds.play(DealSound);
+    };
+
+    // "Hit" button logic
+    auto playerHit = [&]() {
+        if (!buttonLocked && table.hit()) {
+            buttonLocked = true;
+            hit = true;
+            adjustCardPositions(dealerPositions, playerPositions, dealerCards, playerCards, VirtualSize);
+            hitCard.setPosition(initialPosition);
+            animator.moveTo(hitCard, TargetHitCardPosition,
+                travelTime(initialPosition, TargetHitCardPosition, speed), 0, EaseOutCubic,
+                [&]() {
+                    hitCard.setPosition(initialPosition);
+                    hit = false;
+                    // The next hit, stand or restart waits until this card is down
+                    buttonLocked = false;
+                    // A bust is heard once the card that caused it is down
+                    sounds.play(DealSound);
+                    if (gameOver) {
+                        sounds.play(FlipSound);
+                        sounds.play(resultSound(table.result(), playerCards));
+                    }
+                });
+            if (table.state() == RoundOver) {
+                resultMessage = outcomeMessage(table.result().outcome);
+                gameOver = true;
+            }
+        }
+    };
+
+    // "Stand" button logic
+    auto playerStand = [&]() {
+        if (!buttonLocked && table.stand()) {
+            playerTurn = false;
+            adjustCardPositions(dealerPositions, playerPositions, dealerCards, playerCards, VirtualSize);
+            resultMessage = outcomeMessage(table.result().outcome);
+            gameOver = true;
+            sounds.play(FlipSound);
+            sounds.play(resultSound(table.result(), playerCards));
+        }
+    };
+
+    // A replay takes the recorded moves one beat apart: hits until the player holds the recorded cards, then a stand.
+    // The beat is the deck card sitting still for a moment, so the wait runs on the animator like everything else.
+    bool replayStepQueued = false;
+    auto queueReplayStep = [&]() {
+        replayStepQueued = true;
+        animator.moveTo(hitCard, initialPosition, ReplayStepDelay, 0, Linear, [&]() {
+            replayStepQueued = false;
+            if (currentGameState != GameStart || gameOver) return;
+            if (playerCards.size() < replayLog[replayIndex].playerCount) playerHit();
+            else playerStand();
+        });
+    };
+
+    // Every button, label and sum on screen is built once here and only updated when its value changes
+    TableUi ui(font);
+    ui.setBackground(backgroundTexture);
+    ui.layout(VirtualSize);
+
+    // Press H during a round for the EV of hitting and standing, worked out on a worker thread
+    StrategyAdvisor advisor(options.shoe.decks, options.rules);
+    bool showHints = false;
+
+    ProfilerHud profilerHud(font);
+    bool showProfiler = false;
+
+    // Skins load the first time they are shown, the one after the current skin decodes in the background
+    TextureCache skinCache(SkinBudgetBytes, VirtualSize);
+    size_t tableSkin = 0;
+    skinCache.prefetch(TableSkins[1]);
+
+    // Load blur shaders, the pause background is blurred once per pause
+    Blur blur;
+    if (!blur.loadShaders()) {
         return -1;
     }
-
-    // Create a render texture for capturing the game screen
-    sf::RenderTexture blurRenderTexture;
-    blurRenderTexture.create(window.getSize().x, window.getSize().y);
-    if (!blurRenderTexture.create(window.getSize().x, window.getSize().y)) {
-        std::cerr << "Error creating render texture!" << std::endl;
+    blur.setRadius(PauseBlurRadius);
+    bool pauseBackgroundReady = false;
+    startupTimer.mark("shader");
+
+    // The scene is drawn off-screen and then shown in the window, so pausing can blur the last frame on
+    // the GPU instead of reading the window back. It is rendered at the window's resolution times the
+    // render scale, with a view onto the virtual table, and stretched over the window when presented.
+    sf::RenderTexture sceneTexture;
+    auto resizeScene = [&](const sf::Vector2u& size) {
+        if (!sceneTexture.create(size.x, size.y)) {
+            std::cerr << "Error creating render texture!" << std::endl;
+            return false;
+        }
+        sceneTexture.setView(sf::View(sf::FloatRect(0, 0, static_cast<float>(VirtualSize.x), static_cast<float>(VirtualSize.y))));
+        sceneTexture.setSmooth(true);
+        return blur.resize(size);
+    };
+    sf::Vector2u sceneSize = sceneResolution(window.getSize(), options.renderScale);
+    if (!resizeScene(sceneSize)) {
         return -1;
     }
+    std::cout << "Scene resolution: " << sceneSize.x << "x" << sceneSize.y << std::endl;
+    bool sceneLost = false; // The last frame is gone after a resize and has to be drawn again
+
+    // Function to draw whichever scene is showing, without the pause menu. The pause blur draws it
+    // again through here when the last frame is lost.
+    auto drawScene = [&]() {
+        if (hit) {
+            hitGetACard(sceneTexture, ui, atlas, cardVertices, dealerCards, playerCards,
+                dealerPositions, playerPositions, gameOver, cardTop, hitCard);
+        }
+        else if (currentGameState == StartScreen) {
+            // Draw Start Screen
+            ProfileScope scope(TablePhase);
+            ui.drawStartScreen(sceneTexture);
+        }
+        else if (currentGameState == GettingCards) {
+            {
+                ProfileScope scope(TablePhase);
+                ui.drawTable(sceneTexture);
+            }
 
-    // Create a texture to hold the current game screen
-    sf::Texture gameScreenTexture;
-    gameScreenTexture.create(window.getSize().x, window.getSize().y);
+            for (const auto& card : dealtCards) {
+                atlas.appendBack(cardVertices, card.getPosition());
+            }
+            atlas.appendBack(cardVertices, cardTop.getPosition());
+            drawCardBatch(sceneTexture, atlas, cardVertices);
+        }
+        else if (currentGameState == GameStart) {
+            // Draw Game Table and Elements
+            drawGameScene(sceneTexture, ui, atlas, cardVertices, dealerCards, playerCards,
+                dealerPositions, playerPositions, cardTop, gameOver);
+        }
+    };
+    startupTimer.mark("render targets");
 
-    bool buttonLocked = false;
+    bool firstFrame = true;
+    bool needsRedraw = true; // Something on screen changed since the last frame
+    sf::Vector2f mousePosition;
+    bool hoverPending = false; // The mouse moved since the last hover update
     // Main loop to display the window and circle
     while (window.isOpen()) {
+        // With nothing moving and nothing changed, block until the next event instead of redrawing a still frame
+        bool busy = needsRedraw || animator.isAnimating() || !atlas.isComplete() || (paused && !pauseBackgroundReady)
+            || advisor.isThinking() || sounds.isTiming();
+
         // Event handling
         sf::Event event;
-        while (window.pollEvent(event)) {
+        bool hasEvent = busy ? window.pollEvent(event) : window.waitEvent(event);
+        // Time spent blocked waiting for input isn't part of any frame
+        std::int64_t frameStart = profileClock();
+        for (; hasEvent; hasEvent = window.pollEvent(event)) {
+            // Mouse movement only counts when it changes a hover state
+            if (event.type != sf::Event::MouseMoved) {
+                needsRedraw = true;
+            }
+
             if (event.type == sf::Event::Closed) {
                 window.close();
             }
 
-            if (paused) {
-                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                    // Resume button
-                    float buttonX = (window.getSize().x - 200) / 2;
-                    float buttonY = (window.getSize().y - 50) / 2 - 30;
-                    if (event.mouseButton.x > buttonX && event.mouseButton.x < buttonX + 200 &&
-                        event.mouseButton.y > buttonY && event.mouseButton.y < buttonY + 50) {
-                        paused = false;
-                    }
-
-                    // Quit button
-                    float quitButtonX = (window.getSize().x - 200) / 2;
-                    float quitButtonY = (window.getSize().y - 50) / 2 + 50;
-                    if (event.mouseButton.x > quitButtonX && event.mouseButton.x < quitButtonX + 200 &&
-                        event.mouseButton.y > quitButtonY && event.mouseButton.y < quitButtonY + 50) {
-                        window.close();
+            // Render targets follow the window size, and are only re-created when the scene resolution
+            // actually changes. The layout never does, it lives in virtual coordinates.
+            if (event.type == sf::Event::Resized) {
+                sf::Vector2u size(event.size.width, event.size.height);
+                window.setView(sf::View(sf::FloatRect(0, 0, static_cast<float>(size.x), static_cast<float>(size.y))));
+                sf::Vector2u newSceneSize = sceneResolution(size, options.renderScale);
+                // Minimizing can report an empty window, the scene is kept for when it comes back
+                if (newSceneSize != sceneSize && size.x > 0 && size.y > 0) {
+                    // Like at startup, there is nothing to draw into without the render targets
+                    sceneSize = newSceneSize;
+                    if (!resizeScene(sceneSize)) {
+                        return -1;
                     }
+                    sceneLost = true;
+                    pauseBackgroundReady = false;
                 }
-                continue; // Skip other logic when paused
             }
 
-            if (currentGameState == StartScreen) {
-                // Hover effect logic (optional)
-                if (event.type == sf::Event::MouseMoved) {
-                    float buttonWidth = 250, buttonHeight = 80;
-                    float buttonX = (window.getSize().x - buttonWidth) / 2;
-                    float buttonY = 800;
-
-                    // Hover effect for Start button
-                    hoverEffect = (event.mouseMove.x > buttonX &&
-                                event.mouseMove.x < buttonX + buttonWidth &&
-                                event.mouseMove.y > buttonY &&
-                                event.mouseMove.y < buttonY + buttonHeight);
-                }
-
-                // Button click detection
-                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                    float buttonWidth = 250, buttonHeight = 80;
-                    float buttonX = (window.getSize().x - buttonWidth) / 2;
-                    float buttonY = 800;
-
-                    // Start button clicked
-                    if (event.mouseButton.x > buttonX &&
-                        event.mouseButton.x < buttonX + buttonWidth &&
-                        event.mouseButton.y > buttonY &&
-                        event.mouseButton.y < buttonY + buttonHeight) {
-                        std::cout << "Start button clicked!" << std::endl;
-                        currentGameState = GettingCards;
-                        clock.restart();
-                    }
-                }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::H) {
+                showHints = !showHints;
+                continue;
             }
 
-            else {
-                // Game logic
-                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                    // Detect "Pause" button
-                    float pauseButtonX = window.getSize().x - 120; // Top-right corner
-                    float pauseButtonY = 20;
-                    if (event.mouseButton.x > pauseButtonX && event.mouseButton.x < pauseButtonX + 100 &&
-                        event.mouseButton.y > pauseButtonY && event.mouseButton.y < pauseButtonY + 50) {
-                        paused = true;
-                    }
-                    if (!buttonLocked){
-
-                        // Button sizes and positions
-                        sf::Vector2f buttonSize(window.getSize().x * 0.1f, window.getSize().y * 0.08f);
-                        float buttonYPos = window.getSize().y * 0.7f;
-                        float leftOffset = window.getSize().x * 0.2f;
-                        float spacing = window.getSize().x * 0.02f;
-
-                        if (!gameOver) {
-                            // "Hit" button detection
-                            if (event.mouseButton.x > leftOffset &&
-                                event.mouseButton.x < leftOffset + buttonSize.x &&
-                                event.mouseButton.y > buttonYPos &&
-                                event.mouseButton.y < buttonYPos + buttonSize.y) {
-                                // "Hit" button logic
-                                if (!deck.empty()) {
-                                    buttonLocked = true;
-                                    hit = true;
-                                    playerCards.push_back(deck.back());
-                                    deck.pop_back();
-                                    adjustCardPositions(dealerCards, playerCards, window.getSize());
-                                    clock.restart();
-                                    buttonLocked = false;
-                                    if (calculateHandValue(playerCards) > 21) {
-                                        resultMessage = "Dealer Wins!";
-                                        gameOver = true;
-                                        buttonLocked = false;
-                                    }
-                                }
-                            }
-
-                            // "Stand" button detection
-                            if (event.mouseButton.x > leftOffset + buttonSize.x + spacing &&
-                                event.mouseButton.x < leftOffset + 2 * buttonSize.x + spacing &&
-                                event.mouseButton.y > buttonYPos &&
-                                event.mouseButton.y < buttonYPos + buttonSize.y) {
-                                // "Stand" button logic
-                                playerTurn = false;
-                                while (calculateHandValue(dealerCards) < 17 && !deck.empty()) {
-                                    dealerCards.push_back(deck.back());
-                                    deck.pop_back();
-                                    adjustCardPositions(dealerCards, playerCards, window.getSize());
-                                }
-                                resultMessage = determineWinner(dealerCards, playerCards);
-                                gameOver = true;
-                            }
-                        }
-                        else {
-                            // "Restart" button detection
-                            if (event.mouseButton.x > leftOffset &&
-                                event.mouseButton.x < leftOffset + buttonSize.x &&
-                                event.mouseButton.y > buttonYPos &&
-                                event.mouseButton.y < buttonYPos + buttonSize.y) {
-                                // "Restart" button logic
-                                resetGameState(currentGameState, initialPlayerCard1, initialPlayerCard2, 
-                                                initialDealerCard1, initialDealerCard2, PlayerCard1Finished, 
-                                                PlayerCard2Finished, DealerCard1Finished, DealerCard2Finished, initialPosition);
-                                buttonLocked = true;
-                                playerTurn = true;
-                                gameOver = false;
-                                resultMessage.clear();
-                                clock.restart();
-                            }
-                        }
-                    }
-                }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::T) {
+                tableSkin = (tableSkin + 1) % TableSkins.size();
+                ui.setTableSkin(TableSkins[tableSkin] ? skinCache.get(TableSkins[tableSkin]) : nullptr);
+                const char* nextSkin = TableSkins[(tableSkin + 1) % TableSkins.size()];
+                if (nextSkin) skinCache.prefetch(nextSkin);
+                // While paused the last frame holds the pause menu, the table is drawn again under the new skin
+                sceneLost = true;
+                pauseBackgroundReady = false;
+                continue;
             }
-        }
-
-        // Capture the current game screen before drawing
-        // Create a texture to hold the current frame
-        gameScreenTexture.create(window.getSize().x, window.getSize().y);
-        gameScreenTexture.update(window);
 
-        window.clear();
+            // F3 shows where frame time goes, F12 saves the last seconds of it for chrome://tracing
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                showProfiler = !showProfiler;
+                continue;
+            }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F12) {
+                frameProfiler().dumpTrace("trace-" + std::to_string(std::time(nullptr)) + ".json", TraceSeconds);
+                continue;
+            }
 
-        if (paused) {
-            window.setView(window.getDefaultView());
-            gameScreenTexture.update(window);
-            // Draw the blurred background
-            drawPauseMenu(window, font, window.getSize(), blurShader, blurRenderTexture, gameScreenTexture, dealerCards, playerCards, gameOver, cardTop);
-        } else if (hit) {
-            sf::Time deltaTime = clock.restart();
-            float deltaSeconds = deltaTime.asSeconds();
-            if (!HitCardFinished){
-                hitGetACard(window, font, window.getSize(), blurShader, blurRenderTexture, gameScreenTexture, dealerCards, playerCards, gameOver, cardTop, pauseButton, pauseText,
-                hitCard, HitCardFinished, initialPosition, hit, TargetHitCardPosition, speed, deltaSeconds);
-            } else {
-                HitCardFinished = true;
-                hit = false;
-                buttonLocked = false;
-                currentGameState = GameStart;
-            }
-            window.draw(hitCard);
-            
-        }
-        else if (currentGameState == StartScreen) {
-            // Draw Start Screen
-            sf::Sprite backgroundSprite;
-            backgroundSprite.setTexture(backgroundTexture);
-            float scaleX = static_cast<float>(window.getSize().x) / backgroundTexture.getSize().x;
-            float scaleY = static_cast<float>(window.getSize().y) / backgroundTexture.getSize().y;
-            backgroundSprite.setScale(scaleX, scaleY);
-            window.draw(backgroundSprite);
-
-            // Draw Start button
-            sf::RectangleShape startButton(sf::Vector2f(250, 80));
-            sf::Color blackTransparent(0, 0, 0, 200); // Black with 200 alpha for transparency
-            startButton.setFillColor(hoverEffect ? sf::Color(50, 50, 50, 255) : blackTransparent); // Slightly darker on hover
-            startButton.setOutlineColor(sf::Color(255, 255, 255, 150)); // White outline with slight transparency
-            startButton.setOutlineThickness(3);
-            startButton.setPosition((window.getSize().x - 250) / 2, 800); // Adjusted position downwards
-            window.draw(startButton);
-
-            sf::Text startText("Start", font, 40);
-            startText.setFillColor(sf::Color::White);
-            startText.setStyle(sf::Text::Bold);
-            startText.setPosition(startButton.getPosition().x + (250 - startText.getLocalBounds().width) / 2,
-                startButton.getPosition().y + (80 - startText.getLocalBounds().height) / 2 - 10);
-            window.draw(startText);
-
-            if (!musicStarted && backgroundMusic.getStatus() == sf::SoundSource::Stopped){
-                backgroundMusic.play();
-                musicStarted = true;
+            // A fast mouse sends many moves per frame, only the last position is hit-tested
+            if (event.type == sf::Event::MouseMoved) {
+                mousePosition = windowToVirtual(sf::Vector2i(event.mouseMove.x, event.mouseMove.y), window.getSize());
+                hoverPending = true;
+                continue;
             }
-        } else if (currentGameState == GettingCards) {
-            sf::Time deltaTime = clock.restart();
-            float deltaSeconds = deltaTime.asSeconds();
 
-            window.setView(window.getDefaultView());
+            if (event.type != sf::Event::MouseButtonPressed || event.mouseButton.button != sf::Mouse::Left) {
+                continue;
+            }
 
-            drawTable(window, font, window.getSize(), dealerCards, playerCards);
-            buttonLocked = true;
+            // Button click detection
+            sf::Vector2f clickPosition = windowToVirtual(sf::Vector2i(event.mouseButton.x, event.mouseButton.y), window.getSize());
+            mousePosition = clickPosition;
+            hoverPending = true; // The click may swap the buttons under the mouse
+            switch (ui.hitTest(activeLayer(currentGameState, paused, gameOver), clickPosition)) {
+            case ResumeButton:
+                paused = false;
+                break;
 
-            if (!PlayerCard1Finished){
-                sf::Vector2f currentPosition = initialPlayerCard1.getPosition();
-                sf::Vector2f direction = TargetInitialPlayerCard1Position - currentPosition;
-                float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+            case QuitButton:
+                window.close();
+                break;
 
-                if (length > 0){
-                    direction.x /= length;
-                    direction.y /= length;
-                }
+            case StartButton:
+                std::cout << "Start button clicked!" << std::endl;
 
-                if (length > speed * deltaSeconds){
-                    initialPlayerCard1.move(direction * speed * deltaSeconds);
+                // Cards are needed from here on, wait for any still decoding
+                if (!atlas.isComplete()) {
+                    atlas.finishLoading();
+                    startupTimer.mark("card faces");
                 }
-                else {
-                    initialPlayerCard1.setPosition(TargetInitialPlayerCard1Position);
-                    PlayerCard1Finished = true;
-                }
-            } else if (!PlayerCard2Finished){
-                sf::Vector2f currentPosition = initialPlayerCard2.getPosition();
-                sf::Vector2f direction = TargetInitialPlayerCard2Position - currentPosition;
-                float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                if (length > 0){
-                    direction.x /= length;
-                    direction.y /= length;
+                currentGameState = GettingCards;
+                buttonLocked = true;
+                startDealAnimation(animator, dealtCards, dealTargets, initialPosition, speed, cardLanded, finishDeal);
+                break;
+
+            case PauseButton:
+                paused = true;
+                pauseBackgroundReady = false;
+                break;
+
+            case HitButton:
+                // A replay makes its own moves
+                if (!replaying) {
+                    playerHit();
                 }
+                break;
 
-                if (length > speed * deltaSeconds){
-                    initialPlayerCard2.move(direction * speed * deltaSeconds);
-                }
-                else {
-                    initialPlayerCard2.setPosition(TargetInitialPlayerCard2Position);
-                    PlayerCard2Finished = true;
-                }
-            }
-            else if (!DealerCard1Finished)
-            {
-                sf::Vector2f currentPosition = initialDealerCard1.getPosition();
-                sf::Vector2f direction = TargetInitialDealerCard1Position - currentPosition;
-                float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                if (length > 0)
-                {
-                    direction.x /= length;
-                    direction.y /= length;
+            case StandButton:
+                if (!replaying) {
+                    playerStand();
                 }
+                break;
 
-                // Move the sprite towards the target position
-                if (length > speed * deltaSeconds)
-                {
-                    initialDealerCard1.move(direction * speed * deltaSeconds);
+            case RestartButton:
+                // "Restart" button logic
+                if (!buttonLocked) {
+                    if (replaying) {
+                        replayIndex = (replayIndex + 1) % replayLog.size();
+                    }
+                    currentGameState = GettingCards;
+                    buttonLocked = true;
+                    startDealAnimation(animator, dealtCards, dealTargets, initialPosition, speed, cardLanded, finishDeal);
+                    playerTurn = true;
+                    gameOver = false;
+                    resultMessage.clear();
                 }
+                break;
 
-                else
-                {
-                    initialDealerCard1.setPosition(TargetInitialDealerCard1Position);
-                    DealerCard1Finished = true;
-                }
-            } else if (!DealerCard2Finished)
-            {
-                sf::Vector2f currentPosition = initialDealerCard2.getPosition();
-                sf::Vector2f direction = TargetInitialDealerCard2Position - currentPosition;
-                float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-
-                if (length > 0)
-                {
-                    direction.x /= length;
-                    direction.y /= length;
-                }
+            default:
+                break;
+            }
+        }
 
-                // Move the sprite towards the target position
-                if (length > speed * deltaSeconds)
-                {
-                    initialDealerCard2.move(direction * speed * deltaSeconds);
-                }
+        // One hover update per frame, against whatever layer is live after this frame's clicks
+        if (hoverPending) {
+            if (ui.setHovered(ui.hitTest(activeLayer(currentGameState, paused, gameOver), mousePosition))) {
+                needsRedraw = true;
+            }
+            hoverPending = false;
+        }
 
-                else
-                {
-                    initialDealerCard2.setPosition(TargetInitialDealerCard2Position);
-                    DealerCard2Finished = true;
-                }
+        if (replaying && currentGameState == GameStart && !gameOver && !paused && !replayStepQueued && !animator.isAnimating()) {
+            queueReplayStep();
+            needsRedraw = true;
+        }
+
+        // The hint follows the hand in play, answers are only picked up once the worker has them
+        if (showHints && currentGameState == GameStart && !gameOver && !paused) {
+            if (advisor.request(playerCards, dealerCards.front()) && ui.setHint("")) {
+                needsRedraw = true;
             }
-            else if (PlayerCard1Finished && PlayerCard2Finished && DealerCard1Finished && DealerCard2Finished){
-                buttonLocked = false;
-                resetGame(dealerCards, playerCards, deck, textures, window.getSize());
-                currentGameState = GameStart;
+            StrategyHint hint;
+            if (advisor.takeHint(hint) && ui.setHint(hintMessage(hint))) {
+                needsRedraw = true;
             }
+        }
+        else {
+            advisor.clear();
+            if (ui.setHint("")) {
+                needsRedraw = true;
+            }
+        }
 
-            window.draw(initialPlayerCard1);
-            window.draw(initialPlayerCard2);
-            window.draw(initialDealerCard1);
-            window.draw(initialDealerCard2);
-            window.draw(cardTop);
+        frameProfiler().record(EventsPhase, frameStart, profileClock());
+
+        if (!window.isOpen()) {
+            break;
+        }
+        if (!busy) {
+            // Woken by input after idling: the time spent waiting is not animation time
+            clock.restart();
+            frameLimiter.reset();
+        }
+        // Sounds are timed on every pass, a round's result sound usually starts just before the loop goes idle
+        sounds.update();
+        if (!needsRedraw && !animator.isAnimating() && atlas.isComplete()) {
+            // Nothing to draw, but an effect hasn't been heard yet or a hint is still being worked out: look
+            // again shortly rather than block or spin. Nothing is moving either, so the wait is no more
+            // animation time than blocking would be.
+            if (sounds.isTiming() || advisor.isThinking()) {
+                sf::sleep(sf::milliseconds(2));
+                clock.restart();
+            }
+            continue;
+        }
+
+        // Animations advance in fixed steps and stand still while the game is paused
+        sf::Time frameTime = clock.restart();
+        if (!paused) {
+            ProfileScope scope(AnimationPhase);
+            animator.update(frameTime);
+        }
+
+        // Only widgets whose values changed since the last frame rebuild their text
+        // The dealer's sum only counts the upcard until the hole card turns over
+        ui.setSums(gameOver || dealerCards.size() < 2 ? dealerCards.total() : cardValue(dealerCards.front()), playerCards.total());
+        ui.setResult(resultMessage);
+
+        // Pausing blurs the last frame once, the result is reused until unpause or resize
+        if (paused && !pauseBackgroundReady) {
+            if (sceneLost) {
+                sceneTexture.clear();
+                drawScene();
+                sceneTexture.display();
+            }
+            ProfileScope scope(BlurPhase);
+            blur.apply(sceneTexture.getTexture());
+            pauseBackgroundReady = true;
         }
-        else if (currentGameState == GameStart) {
-            window.setView(window.getDefaultView());
-            // Draw Game Table and Elements
-            drawTable(window, font, window.getSize(), dealerCards, playerCards);
 
-            window.draw(cardTop);
-            
-            for (const auto& card : dealerCards) card.draw(window);
-            for (const auto& card : playerCards) card.draw(window);
+        sceneTexture.clear();
 
-            drawButtons(window, font, gameOver, window.getSize());
-            window.draw(pauseButton);
-            window.draw(pauseText);
+        if (paused) {
+            drawPauseMenu(sceneTexture, ui, blur.getResult());
+        }
+        else {
+            drawScene();
 
-            if (gameOver && !resultMessage.empty()) {
-                sf::Text resultText(resultMessage, font, 50);
-                resultText.setFillColor(sf::Color::White);
-                resultText.setStyle(sf::Text::Bold);
-                resultText.setPosition((window.getSize().x - resultText.getLocalBounds().width) / 2,
-                                    (window.getSize().y - resultText.getLocalBounds().height) / 2);
-                window.draw(resultText);
+            if (currentGameState == StartScreen && !musicStarted && backgroundMusic.getStatus() == sf::SoundSource::Stopped) {
+                backgroundMusic.play();
+                musicStarted = true;
             }
         }
 
-        window.display();
+        {
+            ProfileScope scope(PresentPhase);
+            sceneTexture.display();
+            sceneLost = false;
+
+            // Bars fill whatever the table's shape leaves of the window
+            sf::FloatRect viewport = tableViewport(window.getSize());
+            sf::Sprite scene(sceneTexture.getTexture());
+            scene.setPosition(viewport.left, viewport.top);
+            scene.setScale(viewport.width / sceneSize.x, viewport.height / sceneSize.y);
+            window.clear();
+            window.draw(scene);
+            // The overlay goes straight to the window, so it is never blurred or captured with the scene
+            if (showProfiler) {
+                profilerHud.update(frameProfiler());
+                profilerHud.draw(window);
+            }
+            window.display();
+        }
+        needsRedraw = false;
+        {
+            ProfileScope scope(SleepPhase);
+            frameLimiter.endFrame();
+        }
+        frameProfiler().record(FramePhase, frameStart, profileClock());
+
+        if (firstFrame) {
+            startupTimer.mark("first frame");
+            firstFrame = false;
+        }
+
+        // Card faces keep arriving from the decoders while the start screen is up
+        if (!atlas.isComplete() && atlas.uploadDecoded()) {
+            startupTimer.mark("card faces");
+            needsRedraw = true;
+        }
     }
 
+    sounds.report();
     return 0;
 }
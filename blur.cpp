@@ -0,0 +1,78 @@
+#include "blur.hpp"
+#include <algorithm>
+#include <iostream>
+
+// Sample spacing in source texels. At one and a half, the bilinear taps reach past the neighbouring
+// texels and cover the gaps between passes, which keeps the blur smooth.
+const float BlurOffset = 1.5f;
+
+Blur::Blur() : radius(4) {
+}
+
+bool Blur::loadShaders() {
+    if (!downShader.loadFromFile("Shaders/blur_down.frag", sf::Shader::Fragment) ||
+        !upShader.loadFromFile("Shaders/blur_up.frag", sf::Shader::Fragment)) {
+        std::cerr << "Error loading blur shader!" << std::endl;
+        return false;
+    }
+    downShader.setUniform("texture", sf::Shader::CurrentTexture);
+    upShader.setUniform("texture", sf::Shader::CurrentTexture);
+    downShader.setUniform("offset", BlurOffset);
+    upShader.setUniform("offset", BlurOffset);
+    return true;
+}
+
+bool Blur::resize(const sf::Vector2u& newSize) {
+    if (newSize == size && !chain.empty()) return true;
+    size = newSize;
+    chain.clear();
+
+    // Build every level up to the largest radius, smaller ones just stop early
+    sf::Vector2u levelSize = size;
+    for (int level = 0; level <= MaxBlurRadius; ++level) {
+        auto texture = std::make_unique<sf::RenderTexture>();
+        if (!texture->create(levelSize.x, levelSize.y)) {
+            std::cerr << "Error creating render texture!" << std::endl;
+            return false;
+        }
+        texture->setSmooth(true);
+        chain.push_back(std::move(texture));
+
+        levelSize = sf::Vector2u(std::max(1u, levelSize.x / 2), std::max(1u, levelSize.y / 2));
+    }
+    return true;
+}
+
+void Blur::setRadius(int newRadius) {
+    radius = std::clamp(newRadius, 1, MaxBlurRadius);
+}
+
+void Blur::apply(const sf::Texture& source) {
+    // Down the chain, starting from the source
+    pass(source, *chain[1], downShader);
+    for (int level = 2; level <= radius; ++level) {
+        pass(chain[level - 1]->getTexture(), *chain[level], downShader);
+    }
+
+    // And back up again, ending at full size
+    for (int level = radius; level > 0; --level) {
+        pass(chain[level]->getTexture(), *chain[level - 1], upShader);
+    }
+}
+
+const sf::Texture& Blur::getResult() const {
+    return chain[0]->getTexture();
+}
+
+void Blur::pass(const sf::Texture& source, sf::RenderTexture& target, sf::Shader& shader) {
+    sf::Vector2u sourceSize = source.getSize();
+    sf::Vector2u targetSize = target.getSize();
+    shader.setUniform("texelSize", sf::Glsl::Vec2(1.0f / sourceSize.x, 1.0f / sourceSize.y));
+
+    sf::Sprite sprite(source);
+    sprite.setScale(static_cast<float>(targetSize.x) / sourceSize.x, static_cast<float>(targetSize.y) / sourceSize.y);
+
+    target.clear();
+    target.draw(sprite, &shader);
+    target.display();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Dual-filter (Kawase) blur: halve the image a few times, then double it back up.
+// Each pass only touches a quarter of the pixels of the one before, so a wide blur stays cheap.
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <vector>
+
+const int MaxBlurRadius = 6;
+
+class Blur {
+public:
+    Blur();
+
+    bool loadShaders();
+
+    // Size of the images to blur, the render targets are only rebuilt when it changes
+    bool resize(const sf::Vector2u& size);
+
+    // Number of halvings, each one roughly doubles how far the blur spreads
+    void setRadius(int radius);
+
+    // Blur the source into the result texture
+    void apply(const sf::Texture& source);
+
+    // Last blurred image, kept until the next apply or resize
+    const sf::Texture& getResult() const;
+
+private:
+    void pass(const sf::Texture& source, sf::RenderTexture& target, sf::Shader& shader);
+
+    sf::Shader downShader;
+    sf::Shader upShader;
+    sf::Vector2u size;
+    int radius;
+
+    // chain[0] is full size and receives the result, each level after it is half the one before
+    std::vector<std::unique_ptr<sf::RenderTexture>> chain;
+};
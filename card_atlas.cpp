@@ -0,0 +1,177 @@
+#include "card_atlas.hpp"
+#include "asset_bundle.hpp"
+#include "assets.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+const int AtlasColumns = 8;
+
+// Gap between cells so smoothing never samples a neighbouring card
+const float CellPadding = 2.0f;
+
+static std::string cellPath(int cell) {
+    if (cell == CardAtlas::BackCell) return "images/BackColor_Red.png";
+    return "images/" + cardName(Card{ static_cast<std::uint8_t>(cell) }) + ".png";
+}
+
+static sf::Vector2f cellOrigin(int cell, const sf::Vector2f& cellSize) {
+    return sf::Vector2f((cell % AtlasColumns) * (cellSize.x + CellPadding),
+        (cell / AtlasColumns) * (cellSize.y + CellPadding));
+}
+
+// One cell shrunk to the size it is drawn at, or an empty image if it failed to load
+static sf::Image decodeCell(int cell, float scale) {
+    sf::Image source;
+    if (!source.loadFromFile(cellPath(cell))) {
+        std::cerr << "Error loading texture: " << cellPath(cell) << std::endl;
+        return sf::Image();
+    }
+    unsigned width = static_cast<unsigned>(std::ceil(source.getSize().x * scale));
+    unsigned height = static_cast<unsigned>(std::ceil(source.getSize().y * scale));
+    return downscaleImage(source, width, height);
+}
+
+static unsigned atlasRows() {
+    return (CardAtlas::CellCount + AtlasColumns - 1) / AtlasColumns;
+}
+
+CardAtlas::CardAtlas() : scale(1.0f), nextCell(0), uploadedCount(0) {
+    for (auto& ready : decodedReady) ready = false;
+    uploaded.fill(false);
+}
+
+CardAtlas::~CardAtlas() {
+    for (auto& decoder : decoders) decoder.join();
+}
+
+void CardAtlas::startLoading(float scale) {
+    this->scale = scale;
+
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 0; t < threadCount; ++t) {
+        decoders.emplace_back(&CardAtlas::decodeCells, this);
+    }
+}
+
+// Worker loop: keep taking the next cell until every image is decoded
+void CardAtlas::decodeCells() {
+    for (int cell = nextCell++; cell < CellCount; cell = nextCell++) {
+        decoded[cell] = decodeCell(cell, scale);
+        decodedReady[cell].store(true, std::memory_order_release);
+    }
+}
+
+bool CardAtlas::uploadDecoded() {
+    for (int cell = 0; cell < CellCount; ++cell) {
+        if (!uploaded[cell] && decodedReady[cell].load(std::memory_order_acquire)) {
+            uploadCell(cell);
+        }
+    }
+    return isComplete();
+}
+
+void CardAtlas::finishLoading() {
+    for (auto& decoder : decoders) decoder.join();
+    decoders.clear();
+    uploadDecoded();
+}
+
+bool CardAtlas::loadFromBundle(const AssetBundle& bundle) {
+    const BundleEntry* entry = bundle.find(CardAtlasAsset);
+    if (!entry || !bundle.loadTexture(CardAtlasAsset, atlas)) {
+        return false;
+    }
+
+    // The baked layout is the one uploadCell builds, so the cell size falls out of the atlas size
+    cellSize = sf::Vector2f(static_cast<float>(entry->width) / AtlasColumns - CellPadding,
+        static_cast<float>(entry->height) / atlasRows() - CellPadding);
+    nextCell = CellCount;
+    uploaded.fill(true);
+    uploadedCount = CellCount;
+    return true;
+}
+
+sf::Image CardAtlas::bakeImage(float scale) {
+    std::vector<sf::Image> cells;
+    for (int cell = 0; cell < CellCount; ++cell) {
+        sf::Image image = decodeCell(cell, scale);
+        if (image.getSize().x == 0) return sf::Image(); // Already reported
+        if (!cells.empty() && image.getSize() != cells.front().getSize()) {
+            std::cerr << "Card image has a different size from the rest: " << cellPath(cell) << std::endl;
+            return sf::Image();
+        }
+        cells.push_back(image);
+    }
+
+    sf::Vector2f size(static_cast<float>(cells.front().getSize().x), static_cast<float>(cells.front().getSize().y));
+    sf::Image image;
+    image.create(static_cast<unsigned>(AtlasColumns * (size.x + CellPadding)),
+        static_cast<unsigned>(atlasRows() * (size.y + CellPadding)), sf::Color::Transparent);
+    for (int cell = 0; cell < CellCount; ++cell) {
+        sf::Vector2f origin = cellOrigin(cell, size);
+        image.copy(cells[cell], static_cast<unsigned>(origin.x), static_cast<unsigned>(origin.y));
+    }
+    return image;
+}
+
+bool CardAtlas::isComplete() const {
+    return uploadedCount == CellCount;
+}
+
+void CardAtlas::uploadCell(int cell) {
+    uploaded[cell] = true;
+    uploadedCount++;
+
+    sf::Image& image = decoded[cell];
+    if (image.getSize().x == 0) return; // Failed to load, already reported
+
+    // The first card to arrive decides the cell size for the whole atlas
+    if (cellSize.x == 0) {
+        cellSize = sf::Vector2f(static_cast<float>(image.getSize().x), static_cast<float>(image.getSize().y));
+        sf::Image blank;
+        blank.create(static_cast<unsigned>(AtlasColumns * (cellSize.x + CellPadding)),
+            static_cast<unsigned>(atlasRows() * (cellSize.y + CellPadding)), sf::Color::Transparent);
+        if (!atlas.loadFromImage(blank)) {
+            std::cerr << "Error creating card atlas!" << std::endl;
+        }
+        atlas.setSmooth(true);
+    }
+
+    if (image.getSize() != sf::Vector2u(static_cast<unsigned>(cellSize.x), static_cast<unsigned>(cellSize.y))) {
+        std::cerr << "Card image has a different size from the rest: " << cellPath(cell) << std::endl;
+    }
+    else {
+        sf::Vector2f origin = cellOrigin(cell, cellSize);
+        atlas.update(image, static_cast<unsigned>(origin.x), static_cast<unsigned>(origin.y));
+    }
+
+    // Pixels live in the texture now
+    image = sf::Image();
+}
+
+const sf::Texture& CardAtlas::getTexture() const {
+    return atlas;
+}
+
+sf::Vector2f CardAtlas::getCardSize() const {
+    return cellSize;
+}
+
+void CardAtlas::appendCard(sf::VertexArray& vertices, Card card, const sf::Vector2f& position) const {
+    appendCell(vertices, card.id, position);
+}
+
+void CardAtlas::appendBack(sf::VertexArray& vertices, const sf::Vector2f& position) const {
+    appendCell(vertices, BackCell, position);
+}
+
+void CardAtlas::appendCell(sf::VertexArray& vertices, int cell, const sf::Vector2f& position) const {
+    sf::Vector2f origin = cellOrigin(cell, cellSize);
+
+    vertices.append(sf::Vertex(position, origin));
+    vertices.append(sf::Vertex(position + sf::Vector2f(cellSize.x, 0), origin + sf::Vector2f(cellSize.x, 0)));
+    vertices.append(sf::Vertex(position + cellSize, origin + cellSize));
+    vertices.append(sf::Vertex(position + sf::Vector2f(0, cellSize.y), origin + sf::Vector2f(0, cellSize.y)));
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+// All card art packed into a single texture, so every card on the table goes out in one draw call
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "engine.hpp"
+
+class AssetBundle;
+
+class CardAtlas {
+public:
+    // Cells 0-51 hold the faces by card id, the back comes last
+    static const int BackCell = DeckSize;
+    static const int CellCount = DeckSize + 1;
+
+    CardAtlas();
+    ~CardAtlas();
+
+    // Start decoding the 52 faces and the card back on worker threads, each shrunk to the size it is drawn at
+    void startLoading(float scale);
+
+    // Upload whatever the workers have finished into the atlas. Must run on the GL thread,
+    // returns true once every card is in.
+    bool uploadDecoded();
+
+    // Block until every card has been decoded and uploaded
+    void finishLoading();
+
+    // Take the whole atlas from a bundle baked by bakeImage instead, in one upload on the GL thread
+    bool loadFromBundle(const AssetBundle& bundle);
+
+    // Decode every card at the given scale and lay them out the way the atlas holds them, for the
+    // bundle packer. Empty if any card failed to load.
+    static sf::Image bakeImage(float scale);
+
+    bool isComplete() const;
+
+    const sf::Texture& getTexture() const;
+
+    // Size of a card on screen
+    sf::Vector2f getCardSize() const;
+
+    // Append a textured quad for a face-up card or for the card back
+    void appendCard(sf::VertexArray& vertices, Card card, const sf::Vector2f& position) const;
+    void appendBack(sf::VertexArray& vertices, const sf::Vector2f& position) const;
+
+private:
+    void decodeCells();
+    void uploadCell(int cell);
+    void appendCell(sf::VertexArray& vertices, int cell, const sf::Vector2f& position) const;
+
+    sf::Texture atlas;
+    sf::Vector2f cellSize;
+    float scale;
+
+    // Decoded cells are handed from the workers to the GL thread through the ready flags
+    std::vector<std::thread> decoders;
+    std::atomic<int> nextCell;
+    std::array<sf::Image, CellCount> decoded;
+    std::array<std::atomic<bool>, CellCount> decodedReady;
+    std::array<bool, CellCount> uploaded;
+    int uploadedCount;
+};
@@ -0,0 +1,71 @@
+#include "engine.hpp"
+#include <algorithm>
+
+std::string cardName(Card card) {
+    static const char* faces[] = { "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A" };
+    static const char* suits[] = { "S", "H", "D", "C" };
+    return std::string(faces[cardRank(card)]) + suits[cardSuit(card)];
+}
+
+bool isBust(int value) {
+    return value > 21;
+}
+
+bool dealerShouldHit(int dealerValue) {
+    return dealerValue < 17;
+}
+
+bool playerShouldHit(const Hand& player, Card dealerUpcard) {
+    int upcard = cardValue(dealerUpcard);
+    int total = player.total();
+
+    if (player.isSoft()) {
+        if (total <= 17) return true;
+        return total == 18 && upcard >= 9;
+    }
+
+    if (total <= 11) return true;
+    if (total == 12) return upcard < 4 || upcard >= 7;
+    if (total <= 16) return upcard >= 7;
+    return false;
+}
+
+Outcome determineOutcome(int dealerValue, int playerValue) {
+    if (isBust(playerValue)) return DealerWins;
+    if (isBust(dealerValue)) return PlayerWins;
+    if (playerValue > dealerValue) return PlayerWins;
+    if (dealerValue > playerValue) return DealerWins;
+    return Tie;
+}
+
+std::string outcomeMessage(Outcome outcome) {
+    switch (outcome) {
+    case PlayerWins: return "Player Wins!";
+    case DealerWins: return "Dealer Wins!";
+    default: return "It's a Tie!";
+    }
+}
+
+std::string determineWinner(const Hand& dealerHand, const Hand& playerHand) {
+    return outcomeMessage(determineOutcome(dealerHand.total(), playerHand.total()));
+}
+
+bool isPlayablePenetration(const ShoeConfig& config) {
+    size_t size = static_cast<size_t>(std::clamp(config.decks, MinDecks, MaxDecks)) * DeckSize;
+    return config.penetration > 0.0 && static_cast<size_t>(size * config.penetration) <= size - InitialDealSize;
+}
+
+Shoe::Shoe(const ShoeConfig& config) : next(0), roundStart(0) {
+    int decks = std::clamp(config.decks, MinDecks, MaxDecks);
+    double penetration = std::clamp(config.penetration, 0.0, 1.0);
+
+    // Cards start in suit order, deck after deck, until the first shuffle
+    cards.reserve(decks * DeckSize);
+    for (int deck = 0; deck < decks; ++deck) {
+        for (int id = 0; id < DeckSize; ++id) {
+            cards.push_back(Card{ static_cast<std::uint8_t>(id) });
+        }
+    }
+    // Always leave enough behind the cut card for the opening deal
+    cutCard = std::min(static_cast<size_t>(cards.size() * penetration), cards.size() - InitialDealSize);
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+// Blackjack rules with no SFML dependency, shared by the GUI and the simulator
+
+#include "rng.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Result of a finished round from the player's point of view
+enum Outcome {
+    PlayerWins,
+    DealerWins,
+    Tie
+};
+
+enum Rank { Two, Three, Four, Five, Six, Seven, Eight, Nine, Ten, Jack, Queen, King, Ace };
+enum Suit { Spades, Hearts, Diamonds, Clubs };
+
+const int RankCount = 13;
+const int SuitCount = 4;
+const int DeckSize = RankCount * SuitCount;
+
+// Blackjack value of an ace before it is softened down to 1
+const int AceValue = 11;
+
+// A card packed into a single byte as suit * 13 + rank, so it also indexes per-card tables
+struct Card {
+    std::uint8_t id;
+};
+static_assert(sizeof(Card) == 1, "Card must stay one byte");
+
+inline Card makeCard(Rank rank, Suit suit) {
+    return Card{ static_cast<std::uint8_t>(suit * RankCount + rank) };
+}
+
+inline Rank cardRank(Card card) {
+    return static_cast<Rank>(card.id % RankCount);
+}
+
+inline Suit cardSuit(Card card) {
+    return static_cast<Suit>(card.id / RankCount);
+}
+
+// Blackjack value of a card: 2-10 for pips and faces, 11 for an ace
+inline int cardValue(Card card) {
+    static const std::uint8_t values[RankCount] = { 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10, AceValue };
+    return values[cardRank(card)];
+}
+
+// Short name such as "10S" or "AH", matching the image file names
+std::string cardName(Card card);
+
+// Most cards a hand can hold: 21 aces counted as 1, then one more to bust
+const int MaxHandSize = 22;
+
+// A hand that keeps its total up to date as cards are added, so reading it never rescans the cards.
+// Cards are stored inline, so building and copying a hand never allocates.
+class Hand {
+public:
+    void add(Card card) {
+        cards[count++] = card;
+        hardTotal += cardValue(card) == AceValue ? 1 : cardValue(card);
+        aceCount += cardRank(card) == Ace;
+
+        // At most one ace can ever count as 11 without busting
+        soft = aceCount > 0 && hardTotal + 10 <= 21;
+        currentTotal = soft ? hardTotal + 10 : hardTotal;
+    }
+
+    void clear() {
+        count = 0;
+        hardTotal = 0;
+        aceCount = 0;
+        currentTotal = 0;
+        soft = false;
+    }
+
+    int total() const { return currentTotal; }
+    bool isSoft() const { return soft; }
+    bool isBust() const { return hardTotal > 21; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Card operator[](size_t i) const { return cards[i]; }
+    Card front() const { return cards[0]; }
+    const Card* begin() const { return cards; }
+    const Card* end() const { return cards + count; }
+
+private:
+    Card cards[MaxHandSize];
+    std::uint8_t count = 0;
+    std::uint8_t hardTotal = 0; // Every ace counted as 1
+    std::uint8_t aceCount = 0;
+    std::uint8_t currentTotal = 0;
+    bool soft = false;          // An ace is currently counted as 11
+};
+
+bool isBust(int value);
+
+// Dealer keeps drawing until reaching 17
+bool dealerShouldHit(int dealerValue);
+
+// Fixed player strategy used for headless play
+bool playerShouldHit(const Hand& player, Card dealerUpcard);
+
+Outcome determineOutcome(int dealerValue, int playerValue);
+
+// Message shown on the table for a finished round
+std::string outcomeMessage(Outcome outcome);
+
+// Function to determine the winner
+std::string determineWinner(const Hand& dealerHand, const Hand& playerHand);
+
+const int MinDecks = 1;
+const int MaxDecks = 8;
+
+// Two cards each for the dealer and the player
+const size_t InitialDealSize = 4;
+
+// Table conditions for the shoe: how many decks and how deep the cut card sits
+struct ShoeConfig {
+    int decks = 1;
+    double penetration = 0.75; // Fraction of the shoe dealt before reshuffling
+};
+
+// The cut card leaves at least the opening deal behind it. Deeper penetration is clamped by the shoe.
+bool isPlayablePenetration(const ShoeConfig& config);
+
+// Multi-deck shoe that deals by advancing an index and is only reshuffled once the cut card is reached
+class Shoe {
+public:
+    explicit Shoe(const ShoeConfig& config = ShoeConfig());
+
+    // Shuffle every card back into the shoe in place. Fisher-Yates over randomBelow, so a given
+    // generator state always produces the same shoe order regardless of compiler or platform.
+    template <typename Generator>
+    void shuffle(Generator& gen) {
+        for (size_t i = cards.size() - 1; i > 0; --i) {
+            std::swap(cards[i], cards[randomBelow(gen, static_cast<std::uint32_t>(i + 1))]);
+        }
+        next = 0;
+        roundStart = 0;
+    }
+
+    Card deal() {
+        return cards[next++];
+    }
+
+    // Cards dealt from here on are on the table until the next round begins
+    void beginRound() {
+        roundStart = next;
+    }
+
+    // Deal, shuffling the discards back in first if the shoe runs out mid-round, so a round is always
+    // played to the end instead of being settled short
+    template <typename Generator>
+    Card deal(Generator& gen) {
+        if (empty()) shuffleDiscards(gen);
+        return deal();
+    }
+
+    bool empty() const {
+        return next >= cards.size();
+    }
+
+    // The cut card has come out, reshuffle before the next round
+    bool needsShuffle() const {
+        return next >= cutCard;
+    }
+
+    size_t remaining() const {
+        return cards.size() - next;
+    }
+
+    int deckCount() const {
+        return static_cast<int>(cards.size() / DeckSize);
+    }
+
+    // Cards dealt before the cut card comes out, after the penetration is clamped to the shoe
+    size_t cutCardPosition() const {
+        return cutCard;
+    }
+
+    size_t size() const {
+        return cards.size();
+    }
+
+private:
+    // The cards on the table move to the front of the shoe and stay out of play, the discards behind
+    // them are shuffled and dealt next
+    template <typename Generator>
+    void shuffleDiscards(Generator& gen) {
+        if (roundStart == 0) {
+            shuffle(gen);
+            return;
+        }
+        std::rotate(cards.begin(), cards.begin() + roundStart, cards.end());
+        size_t onTable = cards.size() - roundStart;
+        for (size_t i = cards.size() - 1; i > onTable; --i) {
+            std::swap(cards[i], cards[onTable + randomBelow(gen, static_cast<std::uint32_t>(i - onTable + 1))]);
+        }
+        next = onTable;
+        roundStart = 0;
+    }
+
+    std::vector<Card> cards;
+    size_t next;
+    size_t roundStart; // First card dealt this round
+    size_t cutCard;
+};
@@ -0,0 +1,15 @@
+#include "frame_limiter.hpp"
+
+FrameLimiter::FrameLimiter(unsigned int maxFrameRate) : frameTime(sf::seconds(1.0f / maxFrameRate)) {}
+
+void FrameLimiter::endFrame() {
+    sf::Time elapsed = clock.getElapsedTime();
+    if (elapsed < frameTime) {
+        sf::sleep(frameTime - elapsed);
+    }
+    clock.restart();
+}
+
+void FrameLimiter::reset() {
+    clock.restart();
+}
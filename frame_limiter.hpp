@@ -0,0 +1,21 @@
+#pragma once
+
+// Frame rate cap that backs up vsync: it sleeps off whatever is left of a frame, so it costs
+// nothing while vsync already holds frames back and only steps in when vsync is off or forced off
+
+#include <SFML/System.hpp>
+
+class FrameLimiter {
+public:
+    explicit FrameLimiter(unsigned int maxFrameRate);
+
+    // Call once after each frame is shown
+    void endFrame();
+
+    // Call after the loop slept waiting for input, so the idle time doesn't count as a frame
+    void reset();
+
+private:
+    sf::Clock clock;
+    sf::Time frameTime;
+};
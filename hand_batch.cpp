@@ -0,0 +1,216 @@
+#include "hand_batch.hpp"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HAND_BATCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang build the AVX2 kernel for that target alone, the rest of the program stays baseline x86
+#if defined(HAND_BATCH_X86) && !defined(_MSC_VER)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+const std::uint8_t SoftFlag = 1;
+const std::uint8_t BustFlag = 2;
+
+// Point value with the ace counted as 1, the hand's soft total adds the other 10
+static std::uint8_t pointValue(Card card) {
+    return static_cast<std::uint8_t>(cardValue(card) == AceValue ? 1 : cardValue(card));
+}
+
+// Hands [0, count) in whole blocks, values are zero past the end of each hand and of the batch
+static void evaluateScalar(const std::uint8_t* const* slots, int slotCount, size_t count,
+    std::uint8_t* totals, std::uint8_t* flags) {
+    for (size_t hand = 0; hand < count; ++hand) {
+        int hard = 0;
+        bool hasAce = false;
+        for (int slot = 0; slot < slotCount; ++slot) {
+            hard += slots[slot][hand];
+            hasAce = hasAce || slots[slot][hand] == 1;
+        }
+        bool soft = hasAce && hard <= 11;
+        totals[hand] = static_cast<std::uint8_t>(soft ? hard + 10 : hard);
+        flags[hand] = static_cast<std::uint8_t>((soft ? SoftFlag : 0) | (hard > 21 ? BustFlag : 0));
+    }
+}
+
+#ifdef HAND_BATCH_X86
+
+// Sixteen hands per step. Hard totals fit a byte: 22 cards of 10 is 220.
+static void evaluateSse2(const std::uint8_t* const* slots, int slotCount, size_t count,
+    std::uint8_t* totals, std::uint8_t* flags) {
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i elevens = _mm_set1_epi8(11);
+    const __m128i twentyOnes = _mm_set1_epi8(21);
+    const __m128i tens = _mm_set1_epi8(10);
+    const __m128i softBits = _mm_set1_epi8(SoftFlag);
+    const __m128i bustBits = _mm_set1_epi8(BustFlag);
+
+    for (size_t hand = 0; hand < count; hand += 16) {
+        __m128i hard = _mm_setzero_si128();
+        __m128i aces = _mm_setzero_si128();
+        for (int slot = 0; slot < slotCount; ++slot) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slots[slot] + hand));
+            hard = _mm_add_epi8(hard, value);
+            aces = _mm_or_si128(aces, _mm_cmpeq_epi8(value, ones));
+        }
+
+        // Unsigned compares through min: a <= b exactly when min(a, b) == a
+        __m128i soft = _mm_and_si128(aces, _mm_cmpeq_epi8(_mm_min_epu8(hard, elevens), hard));
+        __m128i bust = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_min_epu8(hard, twentyOnes), hard), _mm_set1_epi8(-1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(totals + hand), _mm_add_epi8(hard, _mm_and_si128(soft, tens)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(flags + hand),
+            _mm_or_si128(_mm_and_si128(soft, softBits), _mm_and_si128(bust, bustBits)));
+    }
+}
+
+// The same steps, thirty-two hands at a time
+AVX2_TARGET static void evaluateAvx2(const std::uint8_t* const* slots, int slotCount, size_t count,
+    std::uint8_t* totals, std::uint8_t* flags) {
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i elevens = _mm256_set1_epi8(11);
+    const __m256i twentyOnes = _mm256_set1_epi8(21);
+    const __m256i tens = _mm256_set1_epi8(10);
+    const __m256i softBits = _mm256_set1_epi8(SoftFlag);
+    const __m256i bustBits = _mm256_set1_epi8(BustFlag);
+
+    for (size_t hand = 0; hand < count; hand += 32) {
+        __m256i hard = _mm256_setzero_si256();
+        __m256i aces = _mm256_setzero_si256();
+        for (int slot = 0; slot < slotCount; ++slot) {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slots[slot] + hand));
+            hard = _mm256_add_epi8(hard, value);
+            aces = _mm256_or_si256(aces, _mm256_cmpeq_epi8(value, ones));
+        }
+
+        __m256i soft = _mm256_and_si256(aces, _mm256_cmpeq_epi8(_mm256_min_epu8(hard, elevens), hard));
+        __m256i bust = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(hard, twentyOnes), hard),
+            _mm256_set1_epi8(-1));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(totals + hand),
+            _mm256_add_epi8(hard, _mm256_and_si256(soft, tens)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(flags + hand),
+            _mm256_or_si256(_mm256_and_si256(soft, softBits), _mm256_and_si256(bust, bustBits)));
+    }
+}
+
+#endif
+
+SimdLevel detectSimdLevel() {
+#if defined(HAND_BATCH_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        // AVX2 also needs the OS to save the wide registers, which OSXSAVE plus XCR0 confirm
+        int features[4];
+        __cpuid(features, 1);
+        bool osSavesAvx = (features[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        if (osSavesAvx && (info[1] & (1 << 5))) return Avx2Level;
+    }
+    return Sse2Level;
+#elif defined(HAND_BATCH_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Avx2Level;
+    return Sse2Level;
+#else
+    return ScalarLevel;
+#endif
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case Avx2Level: return "AVX2";
+    case Sse2Level: return "SSE2";
+    default: return "scalar";
+    }
+}
+
+// Detected once, the first time any batch is scored
+static SimdLevel bestSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+HandBatch::HandBatch() : count(0), capacity(0), slotsUsed(0) {
+}
+
+void HandBatch::clear() {
+    for (int slot = 0; slot < slotsUsed; ++slot) {
+        std::fill(values[slot].begin(), values[slot].begin() + count, 0);
+    }
+    std::fill(sizes.begin(), sizes.begin() + count, 0);
+    count = 0;
+    slotsUsed = 0;
+}
+
+size_t HandBatch::size() const {
+    return count;
+}
+
+size_t HandBatch::add(const Hand& hand) {
+    if (count == capacity) grow();
+    size_t index = count++;
+    for (Card card : hand) addCard(index, card);
+    return index;
+}
+
+void HandBatch::addCard(size_t hand, Card card) {
+    int slot = sizes[hand]++;
+    values[slot][hand] = pointValue(card);
+    if (slot + 1 > slotsUsed) slotsUsed = slot + 1;
+}
+
+void HandBatch::evaluate() {
+    evaluate(bestSimdLevel());
+}
+
+void HandBatch::evaluate(SimdLevel level) {
+    if (level > bestSimdLevel()) level = bestSimdLevel();
+
+    // Whole blocks, the padding past the last hand is all zeros and scores as empty hands
+    size_t blocks = (count + BlockSize - 1) / BlockSize * BlockSize;
+    std::array<const std::uint8_t*, MaxHandSize> slots;
+    for (int slot = 0; slot < MaxHandSize; ++slot) slots[slot] = values[slot].data();
+
+    switch (level) {
+#ifdef HAND_BATCH_X86
+    case Avx2Level:
+        evaluateAvx2(slots.data(), slotsUsed, blocks, totals.data(), flags.data());
+        break;
+    case Sse2Level:
+        evaluateSse2(slots.data(), slotsUsed, blocks, totals.data(), flags.data());
+        break;
+#endif
+    default:
+        evaluateScalar(slots.data(), slotsUsed, blocks, totals.data(), flags.data());
+        break;
+    }
+}
+
+int HandBatch::total(size_t hand) const {
+    return totals[hand];
+}
+
+bool HandBatch::isSoft(size_t hand) const {
+    return (flags[hand] & SoftFlag) != 0;
+}
+
+bool HandBatch::isBust(size_t hand) const {
+    return (flags[hand] & BustFlag) != 0;
+}
+
+void HandBatch::grow() {
+    capacity = capacity == 0 ? 1024 : capacity * 2;
+    for (auto& slot : values) slot.resize(capacity, 0);
+    sizes.resize(capacity, 0);
+    totals.resize(capacity, 0);
+    flags.resize(capacity, 0);
+}
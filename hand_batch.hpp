@@ -0,0 +1,62 @@
+#pragma once
+
+// Scores thousands of hands at once. Hands are stored as structure-of-arrays point values, one array
+// per card slot, so the kernel adds up a whole block of hands per instruction. AVX2 and SSE2 kernels
+// are picked at runtime, with a scalar kernel everywhere else.
+
+#include "engine.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+enum SimdLevel {
+    ScalarLevel,
+    Sse2Level,
+    Avx2Level
+};
+
+// Widest kernel the CPU runs
+SimdLevel detectSimdLevel();
+
+const char* simdLevelName(SimdLevel level);
+
+class HandBatch {
+public:
+    // Hands per kernel step, storage is padded to a whole number of blocks
+    static const size_t BlockSize = 32;
+
+    HandBatch();
+
+    void clear();
+    size_t size() const;
+
+    // Append a hand, returns its index in the batch
+    size_t add(const Hand& hand);
+
+    // Deal one more card to a hand already in the batch
+    void addCard(size_t hand, Card card);
+
+    // Score every hand with the best kernel, or with a given one to compare them.
+    // A level the CPU can't run falls back to the next one down.
+    void evaluate();
+    void evaluate(SimdLevel level);
+
+    // Results of the last evaluate
+    int total(size_t hand) const;
+    bool isSoft(size_t hand) const;
+    bool isBust(size_t hand) const;
+
+private:
+    void grow();
+
+    size_t count;
+    size_t capacity;
+    int slotsUsed; // Card slots any hand reaches, the kernel stops there
+
+    // values[slot][hand]: 1 for an ace, 2-10 for the rest, 0 past the end of the hand
+    std::array<std::vector<std::uint8_t>, MaxHandSize> values;
+    std::vector<std::uint8_t> sizes;
+
+    std::vector<std::uint8_t> totals;
+    std::vector<std::uint8_t> flags; // SoftFlag | BustFlag
+};
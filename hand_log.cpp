@@ -0,0 +1,355 @@
+#include "hand_log.hpp"
+#include "rules.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+// Records handed to the writer thread at a time, 256 KB
+const size_t BatchRecords = 4096;
+
+// The file starts with one record's worth of header, so records stay 64-byte aligned in the mapping
+const char LogMagic[8] = { 'B', 'J', 'H', 'A', 'N', 'D', '0', '1' };
+const size_t LogHeaderSize = sizeof(HandRecord);
+
+HandRecord makeHandRecord(const Hand& dealer, const Hand& player, Outcome outcome, double payout) {
+    HandRecord record = {};
+    record.outcome = static_cast<std::uint8_t>(outcome);
+    record.payoutTenths = static_cast<std::int16_t>(std::lround(payout * 10));
+
+    size_t slot = 0;
+    for (Card card : player) {
+        if (slot < RecordCardSlots) record.cards[slot++] = card;
+    }
+    for (Card card : dealer) {
+        if (slot < RecordCardSlots) record.cards[slot++] = card;
+    }
+    record.playerCount = static_cast<std::uint8_t>(player.size());
+    record.dealerCount = static_cast<std::uint8_t>(slot - player.size());
+
+    if (player.isBust()) record.flags |= RecordBust;
+    else if (isNatural(player) || isNatural(dealer)) {
+        record.flags |= RecordNatural;
+    }
+    else record.flags |= RecordStood;
+    return record;
+}
+
+std::uint8_t packRules(const RuleConfig& rules) {
+    return static_cast<std::uint8_t>(RecordRulesSet
+        | (rules.dealerHitsSoft17 ? RecordHitSoft17 : 0)
+        | (rules.doubleAfterSplit ? RecordDoubleAfterSplit : 0)
+        | (rules.surrender ? RecordSurrender : 0)
+        | (rules.payout << RecordPayoutShift));
+}
+
+bool unpackRules(const HandRecord& record, RuleConfig& rules) {
+    int payout = (record.rules >> RecordPayoutShift) & 3;
+    if (!(record.rules & RecordRulesSet) || payout > PaysEvenMoney) return false;
+    rules.dealerHitsSoft17 = (record.rules & RecordHitSoft17) != 0;
+    rules.doubleAfterSplit = (record.rules & RecordDoubleAfterSplit) != 0;
+    rules.surrender = (record.rules & RecordSurrender) != 0;
+    rules.payout = static_cast<BlackjackPayout>(payout);
+    return true;
+}
+
+std::vector<Card> dealOrder(const HandRecord& record) {
+    const Card* player = record.cards;
+    const Card* dealer = record.cards + record.playerCount;
+
+    std::vector<Card> order;
+    order.reserve(record.playerCount + record.dealerCount);
+    order.insert(order.end(), dealer, dealer + std::min<int>(2, record.dealerCount));
+    order.insert(order.end(), player, player + record.playerCount);
+    if (record.dealerCount > 2) {
+        order.insert(order.end(), dealer + 2, dealer + record.dealerCount);
+    }
+    return order;
+}
+
+HandLogWriter::HandLogWriter() : file(nullptr), stopping(false) {
+}
+
+HandLogWriter::~HandLogWriter() {
+    close();
+}
+
+bool HandLogWriter::open(const std::string& path) {
+    close();
+
+    file = std::fopen(path.c_str(), "ab");
+    if (!file) {
+        std::cerr << "Error opening hand log " << path << "!" << std::endl;
+        return false;
+    }
+
+    // A new log gets its header, an existing one is appended to
+    std::fseek(file, 0, SEEK_END);
+    if (std::ftell(file) == 0) {
+        std::uint8_t header[LogHeaderSize] = {};
+        std::memcpy(header, LogMagic, sizeof(LogMagic));
+        std::uint32_t recordSize = sizeof(HandRecord);
+        std::memcpy(header + sizeof(LogMagic), &recordSize, sizeof(recordSize));
+        std::fwrite(header, 1, sizeof(header), file);
+    }
+
+    stopping = false;
+    filling.reserve(BatchRecords);
+    writer = std::thread(&HandLogWriter::run, this);
+    return true;
+}
+
+void HandLogWriter::append(const HandRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    filling.push_back(record);
+    if (filling.size() < BatchRecords) return;
+
+    full.push_back(std::move(filling));
+    if (!spare.empty()) {
+        filling = std::move(spare.back());
+        spare.pop_back();
+    }
+    else {
+        filling = std::vector<HandRecord>();
+        filling.reserve(BatchRecords);
+    }
+    wake.notify_one();
+}
+
+void HandLogWriter::close() {
+    if (!file) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!filling.empty()) full.push_back(std::move(filling));
+        filling = std::vector<HandRecord>();
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+
+    std::fclose(file);
+    file = nullptr;
+    spare.clear();
+}
+
+bool HandLogWriter::isOpen() const {
+    return file != nullptr;
+}
+
+void HandLogWriter::run() {
+    std::vector<std::vector<HandRecord>> batches;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || !full.empty(); });
+        if (full.empty()) break;
+
+        // Write without holding the lock, appends carry on into the next batch meanwhile
+        batches.swap(full);
+        lock.unlock();
+        for (auto& batch : batches) {
+            std::fwrite(batch.data(), sizeof(HandRecord), batch.size(), file);
+            batch.clear();
+        }
+        std::fflush(file);
+        lock.lock();
+
+        for (auto& batch : batches) spare.push_back(std::move(batch));
+        batches.clear();
+    }
+}
+
+HandLogReader::HandLogReader() : records(nullptr), count(0) {
+}
+
+bool HandLogReader::open(const std::string& path) {
+    records = nullptr;
+    count = 0;
+    // The records are read front to back exactly once
+    if (!file.open(path, "hand log", MappedFile::SequentialAccess)) {
+        return false;
+    }
+
+    const std::uint8_t* data = file.data();
+    size_t length = file.size();
+    std::uint32_t recordSize = 0;
+    if (length >= LogHeaderSize) std::memcpy(&recordSize, data + sizeof(LogMagic), sizeof(recordSize));
+    if (length < LogHeaderSize || std::memcmp(data, LogMagic, sizeof(LogMagic)) != 0 || recordSize != sizeof(HandRecord)) {
+        std::cerr << "Error: " << path << " is not a hand log!" << std::endl;
+        file.release();
+        return false;
+    }
+
+    // A record cut short by a crash is left out
+    records = reinterpret_cast<const HandRecord*>(data + LogHeaderSize);
+    count = (length - LogHeaderSize) / sizeof(HandRecord);
+    return true;
+}
+
+size_t HandLogReader::size() const {
+    return count;
+}
+
+const HandRecord& HandLogReader::operator[](size_t i) const {
+    return records[i];
+}
+
+const HandRecord* HandLogReader::begin() const {
+    return records;
+}
+
+const HandRecord* HandLogReader::end() const {
+    return records + count;
+}
+
+// Starting hands the analysis tells apart: hard 4-20, then soft 12-20. Naturals are counted on their own.
+const int HardSituations = 17;
+const int SoftSituations = 9;
+const int Situations = HardSituations + SoftSituations;
+
+// Upcard columns: ace, 2-9, ten-valued
+const int UpcardColumns = 10;
+
+// Too few hands in a cell to show its EV
+const long long MinCellHands = 100;
+
+struct SituationStats {
+    long long hands = 0;
+    long long busts = 0;
+    long long payoutTenths = 0;
+};
+
+// Totals gathered by a single analysis thread
+struct LogStats {
+    long long hands = 0;
+    long long playerWins = 0;
+    long long dealerWins = 0;
+    long long ties = 0;
+    long long busts = 0;
+    long long naturals = 0;
+    long long payoutTenths = 0;
+    std::array<std::array<SituationStats, UpcardColumns>, Situations> situations{};
+};
+
+static int upcardColumn(Card card) {
+    return cardValue(card) == AceValue ? 0 : cardValue(card) - 1;
+}
+
+// Row of a starting hand, -1 for naturals
+static int situationRow(Card first, Card second) {
+    int hard = (cardValue(first) == AceValue ? 1 : cardValue(first)) + (cardValue(second) == AceValue ? 1 : cardValue(second));
+    bool hasAce = cardValue(first) == AceValue || cardValue(second) == AceValue;
+    if (hasAce && hard + 10 <= 21) {
+        return hard + 10 == 21 ? -1 : HardSituations + hard + 10 - 12;
+    }
+    return hard - 4;
+}
+
+static void analyzeRange(const HandRecord* first, const HandRecord* last, LogStats& stats) {
+    for (const HandRecord* record = first; record != last; ++record) {
+        stats.hands++;
+        stats.payoutTenths += record->payoutTenths;
+        switch (record->outcome) {
+        case PlayerWins: stats.playerWins++; break;
+        case DealerWins: stats.dealerWins++; break;
+        default: stats.ties++; break;
+        }
+        bool bust = (record->flags & RecordBust) != 0;
+        stats.busts += bust;
+        stats.naturals += (record->flags & RecordNatural) != 0;
+
+        int row = situationRow(record->cards[0], record->cards[1]);
+        if (row < 0 || record->dealerCount == 0) continue;
+        SituationStats& cell = stats.situations[row][upcardColumn(record->cards[record->playerCount])];
+        cell.hands++;
+        cell.busts += bust;
+        cell.payoutTenths += record->payoutTenths;
+    }
+}
+
+int analyzeHandLog(const std::string& path) {
+    HandLogReader log;
+    if (!log.open(path)) return -1;
+    if (log.size() == 0) {
+        std::cerr << "Error: " << path << " holds no hands!" << std::endl;
+        return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Each thread takes one contiguous slice of the file
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<LogStats> tallies(threadCount);
+    std::vector<std::thread> workers;
+    size_t slice = (log.size() + threadCount - 1) / threadCount;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        size_t first = std::min(log.size(), t * slice);
+        size_t last = std::min(log.size(), first + slice);
+        workers.emplace_back(analyzeRange, log.begin() + first, log.begin() + last, std::ref(tallies[t]));
+    }
+    for (auto& worker : workers) worker.join();
+
+    LogStats total;
+    for (const auto& tally : tallies) {
+        total.hands += tally.hands;
+        total.playerWins += tally.playerWins;
+        total.dealerWins += tally.dealerWins;
+        total.ties += tally.ties;
+        total.busts += tally.busts;
+        total.naturals += tally.naturals;
+        total.payoutTenths += tally.payoutTenths;
+        for (int row = 0; row < Situations; ++row) {
+            for (int column = 0; column < UpcardColumns; ++column) {
+                total.situations[row][column].hands += tally.situations[row][column].hands;
+                total.situations[row][column].busts += tally.situations[row][column].busts;
+                total.situations[row][column].payoutTenths += tally.situations[row][column].payoutTenths;
+            }
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double hands = static_cast<double>(total.hands);
+
+    std::cout << "Read " << total.hands << " hands from " << path << " on " << threadCount << " threads in "
+        << elapsed.count() << " s (" << static_cast<long long>(hands / elapsed.count()) << " hands/sec)" << std::endl;
+    std::cout << "Player wins: " << 100.0 * total.playerWins / hands << "%, "
+        << "Dealer wins: " << 100.0 * total.dealerWins / hands << "%, "
+        << "Ties: " << 100.0 * total.ties / hands << "%" << std::endl;
+    std::cout << "Player busts: " << 100.0 * total.busts / hands << "%, "
+        << "Naturals settled on the deal: " << 100.0 * total.naturals / hands << "%" << std::endl;
+    std::cout << "Player EV: " << 10.0 * total.payoutTenths / hands << "% per hand" << std::endl;
+
+    // EV in percent of the bet for each starting hand against each upcard, with the bust rate of the row
+    const int columnOrder[UpcardColumns] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 0 };
+    const char* upcardLabels[UpcardColumns] = { "A", "2", "3", "4", "5", "6", "7", "8", "9", "T" };
+    std::cout << std::endl << "EV % by starting hand    ";
+    for (int column : columnOrder) std::cout << std::setw(7) << upcardLabels[column];
+    std::cout << std::setw(8) << "bust %" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (int row = 0; row < Situations; ++row) {
+        long long rowHands = 0, rowBusts = 0;
+        for (const auto& cell : total.situations[row]) {
+            rowHands += cell.hands;
+            rowBusts += cell.busts;
+        }
+        if (rowHands < MinCellHands) continue;
+
+        std::string label = row < HardSituations ? "hard " + std::to_string(row + 4)
+            : "soft " + std::to_string(row - HardSituations + 12);
+        std::cout << std::left << std::setw(25) << label << std::right;
+        for (int column : columnOrder) {
+            const SituationStats& cell = total.situations[row][column];
+            if (cell.hands < MinCellHands) std::cout << std::setw(7) << ".";
+            else std::cout << std::setw(7) << 10.0 * cell.payoutTenths / cell.hands;
+        }
+        std::cout << std::setw(8) << 100.0 * rowBusts / rowHands << std::endl;
+    }
+    std::cout << std::defaultfloat;
+    return 0;
+}
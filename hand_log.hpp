@@ -0,0 +1,118 @@
+#pragma once
+
+// Binary hand history. Every finished round becomes one fixed-size record, appended in batches by a
+// writer thread. The reader maps the whole file, so analytics and replay walk the records in place.
+
+#include "engine.hpp"
+#include "mapped_file.hpp"
+#include "rules.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Room for both hands of any round: neither side gets near 18 cards before going over 21
+const int RecordCardSlots = 36;
+
+// Bits of HandRecord::flags
+const std::uint8_t RecordNatural = 1;   // Settled on the deal, the player never acted
+const std::uint8_t RecordBust = 2;      // The player's last hit went over 21
+const std::uint8_t RecordStood = 4;
+
+// Bits of HandRecord::rules. Logs from before rules were recorded have the byte zero, RecordRulesSet tells them apart.
+const std::uint8_t RecordHitSoft17 = 1;
+const std::uint8_t RecordDoubleAfterSplit = 2;
+const std::uint8_t RecordSurrender = 4;
+const std::uint8_t RecordPayoutShift = 3;  // Two bits of BlackjackPayout
+const std::uint8_t RecordRulesSet = 0x80;
+
+// One round, 64 bytes. Fields are written as they sit in memory, little-endian on every supported target.
+// The player's actions are implied by the cards: every card past the second was a hit, then a stand unless bust.
+struct HandRecord {
+    std::uint64_t seed;         // Seed of the table's shuffles, with the stream below it reproduces the shoe
+    std::uint32_t stream;       // Table id, each table shuffles from its own stream of the seed
+    std::uint32_t round;        // Rounds played at the table before this one
+    std::uint16_t shuffle;      // Shuffles of the shoe before this round was dealt
+    std::uint16_t shoePosition; // Cards dealt from the shoe since that shuffle
+    std::uint8_t playerCount;
+    std::uint8_t dealerCount;
+    std::uint8_t outcome;       // Outcome
+    std::uint8_t flags;
+    std::int16_t payoutTenths;  // Net result in tenths of a bet
+    std::uint8_t decks;
+    std::uint8_t rules;         // Table rules of the round, see RecordRulesSet
+    Card cards[RecordCardSlots]; // The player's cards in order, then the dealer's starting with the upcard
+};
+static_assert(sizeof(HandRecord) == 64, "HandRecord must stay 64 bytes");
+
+// Build a record from a finished round
+HandRecord makeHandRecord(const Hand& dealer, const Hand& player, Outcome outcome, double payout);
+
+// The rules byte of a record, and back. unpackRules is false for a record that doesn't carry its rules.
+std::uint8_t packRules(const RuleConfig& rules);
+bool unpackRules(const HandRecord& record, RuleConfig& rules);
+
+// Cards of a record in the order the shoe dealt them: dealer, dealer, player, player, the player's hits,
+// then the dealer's draws
+std::vector<Card> dealOrder(const HandRecord& record);
+
+// Appends records to a log file. append() only copies into the current batch, full batches are
+// written by a background thread. Safe to append from several threads.
+class HandLogWriter {
+public:
+    HandLogWriter();
+    ~HandLogWriter();
+
+    HandLogWriter(const HandLogWriter&) = delete;
+    HandLogWriter& operator=(const HandLogWriter&) = delete;
+
+    // Create the file or add to an existing log
+    bool open(const std::string& path);
+
+    void append(const HandRecord& record);
+
+    // Write out what is buffered and close the file
+    void close();
+
+    bool isOpen() const;
+
+private:
+    void run();
+
+    std::FILE* file;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    std::vector<HandRecord> filling;               // Batch being appended to
+    std::vector<std::vector<HandRecord>> full;     // Batches waiting for the writer
+    std::vector<std::vector<HandRecord>> spare;    // Written batches, kept to be filled again
+};
+
+// Read-only view of a log file, mapped into memory
+class HandLogReader {
+public:
+    HandLogReader();
+
+    HandLogReader(const HandLogReader&) = delete;
+    HandLogReader& operator=(const HandLogReader&) = delete;
+
+    bool open(const std::string& path);
+
+    size_t size() const;
+    const HandRecord& operator[](size_t i) const;
+    const HandRecord* begin() const;
+    const HandRecord* end() const;
+
+private:
+    MappedFile file;
+    const HandRecord* records;
+    size_t count;
+};
+
+// Scan a log on all cores and print win, bust and EV rates, overall and by starting hand against each upcard
+int analyzeHandLog(const std::string& path);
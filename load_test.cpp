@@ -0,0 +1,146 @@
+#include "server.hpp"
+#include "table.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using BotClock = std::chrono::steady_clock;
+
+// What one bot knows about a table it plays, from the replies alone
+struct BotTable {
+    Hand player;
+    Card upcard;
+    BotClock::time_point sent;
+};
+
+// Totals gathered by a single bot
+struct BotTally {
+    long long decisions = 0;
+    long long rounds = 0;
+    long long payoutTenths = 0;
+    long long errors = 0;
+    bool connected = false;
+};
+
+// Play the next action for a table: its next move with the fixed strategy, or a new round
+static bool sendAction(int socket, std::uint32_t id, BotTable& table) {
+    std::uint8_t op = DealRound;
+    if (!table.player.empty()) {
+        op = playerShouldHit(table.player, table.upcard) ? HitCard : StandHand;
+    }
+    RequestBytes bytes = encodeRequest(TableRequest{ op, id });
+    table.sent = BotClock::now();
+    return sendAll(socket, bytes.data(), bytes.size());
+}
+
+// One connection playing its tables with one request in flight on each, until the time is up
+static void runBot(const std::string& address, int tableCount, BotClock::time_point deadline,
+    LatencyHistogram& latency, BotTally& tally) {
+    int socket = connectTo(address);
+    if (socket < 0) return;
+    tally.connected = true;
+
+    // Tables are opened one at a time, each reply carries the id to use
+    std::unordered_map<std::uint32_t, BotTable> tables;
+    RequestBytes request = encodeRequest(TableRequest{ OpenTable, 0 });
+    ResponseBytes bytes;
+    for (int i = 0; i < tableCount; ++i) {
+        if (!sendAll(socket, request.data(), request.size()) || !receiveAll(socket, bytes.data(), bytes.size())) break;
+        TableResponse response = decodeResponse(bytes);
+        if (response.status != StatusOk) {
+            tally.errors++;
+            break;
+        }
+        tables[response.table] = BotTable();
+    }
+
+    size_t inFlight = 0;
+    for (auto& entry : tables) {
+        if (sendAction(socket, entry.first, entry.second)) inFlight++;
+    }
+
+    while (inFlight > 0 && receiveAll(socket, bytes.data(), bytes.size())) {
+        inFlight--;
+        TableResponse response = decodeResponse(bytes);
+        auto found = tables.find(response.table);
+        if (found == tables.end()) {
+            tally.errors++;
+            continue;
+        }
+        BotTable& table = found->second;
+        latency.record(std::chrono::duration_cast<std::chrono::microseconds>(BotClock::now() - table.sent).count());
+
+        if (response.status != StatusOk) {
+            // Start the table over with a fresh deal
+            tally.errors++;
+            table.player.clear();
+        }
+        else {
+            if (table.player.empty()) {
+                table.upcard = response.dealerUpcard;
+            }
+            else {
+                tally.decisions++;
+            }
+            for (int i = 0; i < response.newCardCount; ++i) {
+                table.player.add(response.newCards[i]);
+            }
+            if (response.state == RoundOver) {
+                tally.rounds++;
+                tally.payoutTenths += response.payoutTenths;
+                table.player.clear();
+            }
+        }
+
+        if (BotClock::now() < deadline && sendAction(socket, response.table, table)) inFlight++;
+    }
+
+    closeSocket(socket);
+}
+
+int runLoadTest(const std::string& address, int tables, int seconds) {
+#ifndef _WIN32
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    int botCount = std::max(1, std::min(tables, static_cast<int>(std::thread::hardware_concurrency())));
+    std::vector<LatencyHistogram> latencies(botCount);
+    std::vector<BotTally> tallies(botCount);
+    std::vector<std::thread> bots;
+
+    auto start = BotClock::now();
+    auto deadline = start + std::chrono::seconds(seconds);
+    for (int b = 0; b < botCount; ++b) {
+        int share = tables / botCount + (b < tables % botCount ? 1 : 0);
+        bots.emplace_back(runBot, std::cref(address), share, deadline, std::ref(latencies[b]), std::ref(tallies[b]));
+    }
+    for (auto& bot : bots) bot.join();
+
+    std::chrono::duration<double> elapsed = BotClock::now() - start;
+
+    BotTally total;
+    std::vector<std::uint64_t> counts;
+    for (int b = 0; b < botCount; ++b) {
+        total.decisions += tallies[b].decisions;
+        total.rounds += tallies[b].rounds;
+        total.payoutTenths += tallies[b].payoutTenths;
+        total.errors += tallies[b].errors;
+        total.connected = total.connected || tallies[b].connected;
+        latencies[b].collect(counts, false);
+    }
+    if (!total.connected) return -1;
+
+    std::cout << botCount << " bots played " << tables << " tables for " << elapsed.count() << " s: "
+        << total.rounds << " rounds, " << static_cast<long long>(total.decisions / elapsed.count())
+        << " decisions/s" << std::endl;
+    std::cout << "Round trip p50 " << latencyPercentile(counts, 0.5) << " us, p99 "
+        << latencyPercentile(counts, 0.99) << " us, p99.9 " << latencyPercentile(counts, 0.999) << " us" << std::endl;
+    if (total.rounds > 0) {
+        std::cout << "Player result " << 10.0 * total.payoutTenths / total.rounds << "% per round, "
+            << total.errors << " rejected requests" << std::endl;
+    }
+    return total.errors == 0 ? 0 : -1;
+}
@@ -0,0 +1,96 @@
+#include "mapped_file.hpp"
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : bytes(nullptr), length(0) {
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+bool MappedFile::open(const std::string& path, const std::string& kind, AccessHint hint) {
+    release();
+
+#ifdef _WIN32
+    // The handles can go as soon as the view exists, the view keeps the mapping alive
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        hint == SequentialAccess ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize;
+    if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &fileSize)) {
+        std::cerr << "Error opening " << kind << " " << path << "!" << std::endl;
+        if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    HANDLE mapping = length > 0 ? CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    void* mapped = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(handle);
+    if (!mapped) {
+        std::cerr << "Error mapping " << kind << " " << path << "!" << std::endl;
+        length = 0;
+        return false;
+    }
+    bytes = static_cast<const std::uint8_t*>(mapped);
+
+    // The counterpart of MADV_WILLNEED: page it all in up front, e.g. a bundle about to be uploaded
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+    if (hint == WholeFileAccess) {
+        WIN32_MEMORY_RANGE_ENTRY range = { mapped, length };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#endif
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        std::cerr << "Error opening " << kind << " " << path << "!" << std::endl;
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(info.st_size);
+    void* mapped = length > 0 ? mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error mapping " << kind << " " << path << "!" << std::endl;
+        length = 0;
+        return false;
+    }
+    madvise(mapped, length, hint == SequentialAccess ? MADV_SEQUENTIAL : MADV_WILLNEED);
+    bytes = static_cast<const std::uint8_t*>(mapped);
+#endif
+    return true;
+}
+
+void MappedFile::release() {
+#ifdef _WIN32
+    if (bytes) UnmapViewOfFile(bytes);
+#else
+    if (bytes) munmap(const_cast<std::uint8_t*>(bytes), length);
+#endif
+    bytes = nullptr;
+    length = 0;
+}
+
+const std::uint8_t* MappedFile::data() const {
+    return bytes;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
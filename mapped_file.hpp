@@ -0,0 +1,34 @@
+#pragma once
+
+// Read-only view of a whole file, mapped into memory so callers read it in place and the OS pages it in
+// as they go.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile {
+public:
+    // How the contents will be read, passed on to the OS readahead
+    enum AccessHint {
+        SequentialAccess, // Walked front to back once
+        WholeFileAccess   // All of it is needed right away
+    };
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Errors name the file as the given kind, e.g. "hand log"
+    bool open(const std::string& path, const std::string& kind, AccessHint hint);
+    void release();
+
+    const std::uint8_t* data() const;
+    size_t size() const;
+
+private:
+    const std::uint8_t* bytes;
+    size_t length;
+};
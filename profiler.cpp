@@ -0,0 +1,91 @@
+#include "profiler.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+static const char* const PhaseNames[PhaseCount] = {
+    "frame", "events", "animation", "blur", "table", "cards", "ui", "present", "sleep"
+};
+
+// Small per-thread ids for the trace, in order of each thread's first event
+static std::atomic<std::uint32_t> nextThreadId(0);
+static thread_local std::uint32_t threadId = nextThreadId++;
+
+const char* phaseName(ProfilePhase phase) {
+    return PhaseNames[phase];
+}
+
+std::int64_t profileClock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameProfiler::FrameProfiler() : head(0), slots(Capacity) {
+    for (auto& slot : slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+void FrameProfiler::record(ProfilePhase phase, std::int64_t start, std::int64_t end) {
+    std::uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index & (Capacity - 1)];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.phase.store(phase, std::memory_order_relaxed);
+    slot.thread.store(threadId, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+void FrameProfiler::collect(std::int64_t since, std::vector<ProfileEvent>& events) const {
+    events.clear();
+    std::uint64_t end = head.load(std::memory_order_acquire);
+    std::uint64_t begin = end > Capacity ? end - Capacity : 0;
+
+    for (std::uint64_t index = begin; index < end; ++index) {
+        const Slot& slot = slots[index & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != 2 * index + 2) continue;
+
+        ProfileEvent event{ static_cast<ProfilePhase>(slot.phase.load(std::memory_order_relaxed)),
+            slot.thread.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+            slot.duration.load(std::memory_order_relaxed) };
+
+        // Overwritten while it was read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != 2 * index + 2) continue;
+
+        if (event.start >= since) events.push_back(event);
+    }
+}
+
+bool FrameProfiler::dumpTrace(const std::string& path, double seconds) const {
+    std::vector<ProfileEvent> events;
+    collect(profileClock() - static_cast<std::int64_t>(seconds * 1e9), events);
+
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error writing trace " << path << "!" << std::endl;
+        return false;
+    }
+
+    // Complete events with microsecond timestamps, one row per thread
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    std::int64_t origin = events.empty() ? 0 : events.front().start;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const ProfileEvent& event = events[i];
+        out << "{\"name\":\"" << phaseName(event.phase) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << (event.start - origin) / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}"
+            << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+
+    std::cout << "Wrote " << events.size() << " profile events to " << path << std::endl;
+    return static_cast<bool>(out);
+}
+
+FrameProfiler& frameProfiler() {
+    static FrameProfiler profiler;
+    return profiler;
+}
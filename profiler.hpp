@@ -0,0 +1,85 @@
+#pragma once
+
+// Frame profiler: scoped timers around the phases of a frame, recorded into a lock-free ring buffer
+// that always holds the last minute or so of frames. The HUD reads it live and a hotkey dumps it
+// as Chrome trace events (chrome://tracing or ui.perfetto.dev).
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum ProfilePhase {
+    FramePhase,     // Everything from input to the frame leaving the limiter
+    EventsPhase,    // Polling input, hover and hint updates
+    AnimationPhase,
+    BlurPhase,      // Blurring the table behind the pause menu
+    TablePhase,     // Background and labels
+    CardsPhase,     // The card batch
+    UiPhase,        // Buttons, hint and result
+    PresentPhase,   // Scene to window and display, vsync waits land here
+    SleepPhase,     // Frame limiter
+    PhaseCount
+};
+
+// Name shown in the HUD and the trace
+const char* phaseName(ProfilePhase phase);
+
+// Nanoseconds on a steady clock
+std::int64_t profileClock();
+
+struct ProfileEvent {
+    ProfilePhase phase;
+    std::uint32_t thread;
+    std::int64_t start;
+    std::int64_t duration;
+};
+
+// Any thread can record, the reader never blocks a writer. A slot is tagged with the sequence number of
+// the write that filled it, so a reader skips slots that are being overwritten under it.
+class FrameProfiler {
+public:
+    // 2^16 events, about a minute of frames at 120 Hz
+    static const int CapacityBits = 16;
+    static const std::uint64_t Capacity = std::uint64_t(1) << CapacityBits;
+
+    FrameProfiler();
+
+    void record(ProfilePhase phase, std::int64_t start, std::int64_t end);
+
+    // Events that started at or after the given time, oldest first
+    void collect(std::int64_t since, std::vector<ProfileEvent>& events) const;
+
+    // Write the last seconds of events as Chrome trace-event JSON
+    bool dumpTrace(const std::string& path, double seconds) const;
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> sequence; // 2n + 1 while write n fills the slot, 2n + 2 once done
+        std::atomic<std::uint32_t> phase;
+        std::atomic<std::uint32_t> thread;
+        std::atomic<std::int64_t> start;
+        std::atomic<std::int64_t> duration;
+    };
+
+    std::atomic<std::uint64_t> head;
+    std::vector<Slot> slots;
+};
+
+// The profiler the game's timers record into
+FrameProfiler& frameProfiler();
+
+// Times the enclosing block
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePhase phase) : phase(phase), start(profileClock()) {}
+    ~ProfileScope() { frameProfiler().record(phase, start, profileClock()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfilePhase phase;
+    std::int64_t start;
+};
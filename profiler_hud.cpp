@@ -0,0 +1,91 @@
+#include "profiler_hud.hpp"
+#include <algorithm>
+#include <cstdio>
+
+// Seconds of frames the numbers are taken over, and how often they are refreshed
+const double HudWindowSeconds = 2.0;
+const std::int64_t HudRefreshNs = 250000000;
+
+// Bars are drawn to scale against the 120 Hz frame budget
+const float BudgetMs = 1000.0f / 120.0f;
+const float PixelsPerMs = 36.0f;
+
+const float HudLeft = 20;
+const float HudTop = 20;
+const float HudWidth = 460;
+const float RowHeight = 22;
+
+ProfilerHud::ProfilerHud(const sf::Font& font) : lastUpdate(0) {
+    panel.setPosition(HudLeft, HudTop);
+    panel.setSize(sf::Vector2f(HudWidth, 40 + RowHeight * BarCount));
+    panel.setFillColor(sf::Color(0, 0, 0, 180));
+
+    summary.setFont(font);
+    summary.setCharacterSize(16);
+    summary.setFillColor(sf::Color::White);
+    summary.setPosition(HudLeft + 10, HudTop + 6);
+
+    float barLeft = HudLeft + 120;
+    budget.setPosition(barLeft + BudgetMs * PixelsPerMs, HudTop + 34);
+    budget.setSize(sf::Vector2f(1, RowHeight * BarCount));
+    budget.setFillColor(sf::Color(255, 80, 80));
+
+    for (int i = 0; i < BarCount; ++i) {
+        float rowTop = HudTop + 36 + RowHeight * i;
+        labels[i].setFont(font);
+        labels[i].setCharacterSize(14);
+        labels[i].setFillColor(sf::Color::White);
+        labels[i].setPosition(HudLeft + 10, rowTop);
+        bars[i].setPosition(barLeft, rowTop + 3);
+        bars[i].setFillColor(sf::Color(90, 200, 120));
+    }
+}
+
+void ProfilerHud::update(const FrameProfiler& profiler) {
+    std::int64_t now = profileClock();
+    if (now - lastUpdate < HudRefreshNs) return;
+    lastUpdate = now;
+
+    profiler.collect(now - static_cast<std::int64_t>(HudWindowSeconds * 1e9), events);
+
+    std::array<std::int64_t, PhaseCount> phaseTotals{};
+    frameTimes.clear();
+    for (const ProfileEvent& event : events) {
+        phaseTotals[event.phase] += event.duration;
+        if (event.phase == FramePhase) frameTimes.push_back(event.duration);
+    }
+
+    char line[160];
+    if (frameTimes.empty()) {
+        std::snprintf(line, sizeof(line), "no frames drawn in the last %.0f s", HudWindowSeconds);
+    }
+    else {
+        std::sort(frameTimes.begin(), frameTimes.end());
+        auto percentile = [&](double fraction) {
+            return frameTimes[std::min(frameTimes.size() - 1, static_cast<size_t>(fraction * frameTimes.size()))] / 1e6;
+        };
+        std::snprintf(line, sizeof(line), "%zu frames  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f ms",
+            frameTimes.size(), percentile(0.5), percentile(0.9), percentile(0.99), frameTimes.back() / 1e6);
+    }
+    summary.setString(line);
+
+    // Average time per drawn frame in each phase
+    double frames = std::max<size_t>(1, frameTimes.size());
+    for (int i = 0; i < BarCount; ++i) {
+        ProfilePhase phase = static_cast<ProfilePhase>(i + 1);
+        double ms = phaseTotals[phase] / 1e6 / frames;
+        std::snprintf(line, sizeof(line), "%-9s %5.2f", phaseName(phase), ms);
+        labels[i].setString(line);
+        bars[i].setSize(sf::Vector2f(std::min(static_cast<float>(ms) * PixelsPerMs, HudWidth - 130), RowHeight - 6));
+    }
+}
+
+void ProfilerHud::draw(sf::RenderTarget& target) const {
+    target.draw(panel);
+    target.draw(summary);
+    for (int i = 0; i < BarCount; ++i) {
+        target.draw(bars[i]);
+        target.draw(labels[i]);
+    }
+    target.draw(budget);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Overlay for the frame profiler: frame-time percentiles and one bar per phase, averaged over the last
+// couple of seconds of drawn frames
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "profiler.hpp"
+
+class ProfilerHud {
+public:
+    explicit ProfilerHud(const sf::Font& font);
+
+    // Refresh the numbers from the profiler, a few times a second at most
+    void update(const FrameProfiler& profiler);
+
+    void draw(sf::RenderTarget& target) const;
+
+private:
+    // Every phase but the frame itself gets a bar
+    static const int BarCount = PhaseCount - 1;
+
+    sf::RectangleShape panel;
+    sf::Text summary;
+    sf::RectangleShape budget; // Marks one frame at the target rate
+    std::array<sf::RectangleShape, BarCount> bars;
+    std::array<sf::Text, BarCount> labels;
+
+    std::vector<ProfileEvent> events;
+    std::vector<std::int64_t> frameTimes;
+    std::int64_t lastUpdate;
+};
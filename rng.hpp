@@ -0,0 +1,76 @@
+#pragma once
+
+// Small, fast and seedable random number generation for shuffling
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+// xoshiro256** generator: 32 bytes of state and the same sequence for a given seed on every platform.
+// Satisfies UniformRandomBitGenerator so it can also be handed to the standard library.
+class Rng {
+public:
+    using result_type = std::uint64_t;
+
+    // Different stream numbers give independent sequences from the same seed, one per thread or batch
+    explicit Rng(std::uint64_t seed = 0, std::uint64_t stream = 0) {
+        std::uint64_t mix = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (auto& word : state) {
+            word = splitMix64(mix);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Spreads a seed over the whole state so nearby seeds still give unrelated sequences
+    static std::uint64_t splitMix64(std::uint64_t& x) {
+        std::uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    std::uint64_t state[4];
+};
+
+// Uniform integer in [0, bound) using Lemire's multiply-shift, with no modulo bias.
+// Unlike std::uniform_int_distribution the result is the same on every standard library.
+template <typename Generator>
+std::uint32_t randomBelow(Generator& gen, std::uint32_t bound) {
+    std::uint64_t product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(gen())) * bound;
+    std::uint32_t low = static_cast<std::uint32_t>(product);
+    if (low < bound) {
+        std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+        while (low < threshold) {
+            product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(gen())) * bound;
+            low = static_cast<std::uint32_t>(product);
+        }
+    }
+    return static_cast<std::uint32_t>(product >> 32);
+}
+
+// Fresh seed from the OS, taken once at startup and reported so the run can be replayed
+inline std::uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+}
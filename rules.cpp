@@ -0,0 +1,60 @@
+#include "rules.hpp"
+
+bool playerShouldDouble(const Hand& player, Card dealerUpcard) {
+    if (player.size() != 2) return false;
+    int upcard = cardValue(dealerUpcard);
+    int total = player.total();
+
+    if (player.isSoft()) {
+        return total >= 13 && total <= 18 && upcard >= 5 && upcard <= 6;
+    }
+    if (total == 11) return upcard <= 10;
+    if (total == 10) return upcard <= 9;
+    if (total == 9) return upcard >= 3 && upcard <= 6;
+    return false;
+}
+
+bool playerShouldSplit(const Hand& player, Card dealerUpcard) {
+    if (player.size() != 2 || cardValue(player[0]) != cardValue(player[1])) return false;
+    int upcard = cardValue(dealerUpcard);
+
+    switch (cardValue(player[0])) {
+    case AceValue:
+    case 8: return true;
+    case 9: return upcard <= 9 && upcard != 7;
+    case 2:
+    case 3:
+    case 7: return upcard <= 7;
+    case 6: return upcard <= 6;
+    default: return false; // Fours, fives and tens play better as a total
+    }
+}
+
+bool playerShouldSurrender(const Hand& player, Card dealerUpcard) {
+    if (player.size() != 2 || player.isSoft()) return false;
+    int upcard = cardValue(dealerUpcard);
+    return (player.total() == 16 && upcard >= 9) || (player.total() == 15 && upcard == 10);
+}
+
+TableRules makeTableRules(const RuleConfig& config) {
+    return dispatchRules(config, [](auto rules) {
+        using R = decltype(rules);
+        return TableRules{ &dealerHits<R>, &settle<R> };
+    });
+}
+
+bool parsePayout(const std::string& text, BlackjackPayout& payout) {
+    if (text == "3:2") payout = PaysThreeToTwo;
+    else if (text == "6:5") payout = PaysSixToFive;
+    else if (text == "1:1") payout = PaysEvenMoney;
+    else return false;
+    return true;
+}
+
+std::string describeRules(const RuleConfig& config) {
+    const char* payouts[] = { "3:2", "6:5", "1:1" };
+    return std::string(config.dealerHitsSoft17 ? "H17" : "S17")
+        + (config.doubleAfterSplit ? ", DAS" : ", no DAS")
+        + (config.surrender ? ", late surrender" : ", no surrender")
+        + ", blackjack pays " + payouts[config.payout];
+}
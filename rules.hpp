@@ -0,0 +1,191 @@
+#pragma once
+
+// Table rule variants. Each variant is a set of compile-time constants, so the round logic is built
+// once per variant with no rule checks left in it. RuleConfig and dispatchRules pick the variant at runtime.
+
+#include "engine.hpp"
+#include <string>
+
+enum BlackjackPayout {
+    PaysThreeToTwo,
+    PaysSixToFive,
+    PaysEvenMoney
+};
+
+// What a blackjack pays per unit bet
+constexpr double payoutRatio(BlackjackPayout payout) {
+    return payout == PaysThreeToTwo ? 1.5 : payout == PaysSixToFive ? 1.2 : 1.0;
+}
+
+// Table rules picked at runtime, from the command line. Insurance isn't among them: it is a side bet
+// offered the same way at every table, and basic strategy never takes it, so the fixed strategy, the
+// chart and the GUI all play without it.
+struct RuleConfig {
+    bool dealerHitsSoft17 = false;
+    bool doubleAfterSplit = true;
+    bool surrender = false;        // Late surrender, after the dealer has checked for blackjack
+    BlackjackPayout payout = PaysThreeToTwo;
+};
+
+// The same rules as constants for the engine to be built against
+template <bool HitSoft17, bool DoubleAfterSplit, bool LateSurrender, BlackjackPayout Payout>
+struct Rules {
+    static constexpr bool dealerHitsSoft17 = HitSoft17;
+    static constexpr bool doubleAfterSplit = DoubleAfterSplit;
+    static constexpr bool surrender = LateSurrender;
+    static constexpr double blackjackPays = payoutRatio(Payout);
+};
+
+// How a round ended, and what it paid in units of the initial bet, doubles and splits included
+struct RoundResult {
+    Outcome outcome;
+    double payout;
+};
+
+// Two-card 21 straight from the deal
+inline bool isNatural(const Hand& hand) {
+    return hand.size() == 2 && hand.total() == 21;
+}
+
+template <typename R>
+bool dealerHits(const Hand& dealer) {
+    if constexpr (R::dealerHitsSoft17) {
+        return dealer.total() < 17 || (dealer.total() == 17 && dealer.isSoft());
+    }
+    else {
+        return dealerShouldHit(dealer.total());
+    }
+}
+
+// Fixed player strategy for the decisions beyond hit or stand, used for headless play
+bool playerShouldDouble(const Hand& player, Card dealerUpcard);
+bool playerShouldSplit(const Hand& player, Card dealerUpcard);
+bool playerShouldSurrender(const Hand& player, Card dealerUpcard);
+
+// Settle a finished hand that wasn't split, naturals included
+template <typename R>
+RoundResult settle(const Hand& dealer, const Hand& player) {
+    bool dealerNatural = isNatural(dealer);
+    bool playerNatural = isNatural(player);
+    if (dealerNatural || playerNatural) {
+        if (dealerNatural && playerNatural) return RoundResult{ Tie, 0.0 };
+        if (playerNatural) return RoundResult{ PlayerWins, R::blackjackPays };
+        return RoundResult{ DealerWins, -1.0 };
+    }
+
+    Outcome outcome = determineOutcome(dealer.total(), player.total());
+    return RoundResult{ outcome, outcome == PlayerWins ? 1.0 : outcome == DealerWins ? -1.0 : 0.0 };
+}
+
+// Play out one player hand with the fixed strategy, returns the bet it ends up carrying
+template <typename R, typename Generator>
+int playHand(Shoe& shoe, Generator& gen, Hand& hand, Card dealerUpcard, bool canDouble) {
+    if (canDouble && playerShouldDouble(hand, dealerUpcard)) {
+        hand.add(shoe.deal(gen));
+        return 2;
+    }
+    while (playerShouldHit(hand, dealerUpcard)) {
+        hand.add(shoe.deal(gen));
+    }
+    return 1;
+}
+
+// Deals and plays a full round from the shoe. The discards are shuffled back in with gen if the shoe
+// runs out before the round is over.
+template <typename R, typename Generator>
+RoundResult playRound(Shoe& shoe, Generator& gen) {
+    Hand dealerCards, playerCards;
+
+    // Deal initial cards in table order
+    shoe.beginRound();
+    dealerCards.add(shoe.deal(gen));
+    dealerCards.add(shoe.deal(gen));
+    playerCards.add(shoe.deal(gen));
+    playerCards.add(shoe.deal(gen));
+    Card upcard = dealerCards.front();
+
+    // The dealer checks for blackjack before anyone acts. Insurance would be offered here on an ace up,
+    // and is always declined.
+    if (isNatural(dealerCards) || isNatural(playerCards)) {
+        return settle<R>(dealerCards, playerCards);
+    }
+
+    if constexpr (R::surrender) {
+        if (playerShouldSurrender(playerCards, upcard)) return RoundResult{ DealerWins, -0.5 };
+    }
+
+    // Split once at most. Split aces take one card each, other split hands play on as usual.
+    Hand hands[2];
+    int bets[2] = { 1, 0 };
+    int handCount = 1;
+    if (playerShouldSplit(playerCards, upcard)) {
+        bool aces = cardRank(playerCards[0]) == Ace;
+        handCount = 2;
+        for (int h = 0; h < handCount; ++h) {
+            hands[h].add(playerCards[h]);
+            hands[h].add(shoe.deal(gen));
+            bets[h] = aces ? 1 : playHand<R>(shoe, gen, hands[h], upcard, R::doubleAfterSplit);
+        }
+    }
+    else {
+        hands[0] = playerCards;
+        bets[0] = playHand<R>(shoe, gen, hands[0], upcard, true);
+    }
+
+    bool anyLive = false;
+    for (int h = 0; h < handCount; ++h) {
+        anyLive = anyLive || !hands[h].isBust();
+    }
+    while (anyLive && dealerHits<R>(dealerCards)) {
+        dealerCards.add(shoe.deal(gen));
+    }
+
+    double payout = 0;
+    for (int h = 0; h < handCount; ++h) {
+        Outcome outcome = determineOutcome(dealerCards.total(), hands[h].total());
+        payout += outcome == PlayerWins ? bets[h] : outcome == DealerWins ? -bets[h] : 0;
+    }
+    return RoundResult{ payout > 0 ? PlayerWins : payout < 0 ? DealerWins : Tie, payout };
+}
+
+// Calls visit(Rules<...>()) with the variant matching the config, and returns what it returns
+template <bool HitSoft17, bool DoubleAfterSplit, bool LateSurrender, typename Visitor>
+auto dispatchPayout(const RuleConfig& config, Visitor& visit) {
+    switch (config.payout) {
+    case PaysSixToFive: return visit(Rules<HitSoft17, DoubleAfterSplit, LateSurrender, PaysSixToFive>());
+    case PaysEvenMoney: return visit(Rules<HitSoft17, DoubleAfterSplit, LateSurrender, PaysEvenMoney>());
+    default: return visit(Rules<HitSoft17, DoubleAfterSplit, LateSurrender, PaysThreeToTwo>());
+    }
+}
+
+template <bool HitSoft17, bool DoubleAfterSplit, typename Visitor>
+auto dispatchSurrender(const RuleConfig& config, Visitor& visit) {
+    if (config.surrender) return dispatchPayout<HitSoft17, DoubleAfterSplit, true>(config, visit);
+    return dispatchPayout<HitSoft17, DoubleAfterSplit, false>(config, visit);
+}
+
+template <bool HitSoft17, typename Visitor>
+auto dispatchDoubleAfterSplit(const RuleConfig& config, Visitor& visit) {
+    if (config.doubleAfterSplit) return dispatchSurrender<HitSoft17, true>(config, visit);
+    return dispatchSurrender<HitSoft17, false>(config, visit);
+}
+
+template <typename Visitor>
+auto dispatchRules(const RuleConfig& config, Visitor visit) {
+    if (config.dealerHitsSoft17) return dispatchDoubleAfterSplit<true>(config, visit);
+    return dispatchDoubleAfterSplit<false>(config, visit);
+}
+
+// Rule checks for the GUI, bound once to the variant for the configured rules
+struct TableRules {
+    bool (*dealerShouldHit)(const Hand& dealer);
+    RoundResult (*settle)(const Hand& dealer, const Hand& player);
+};
+
+TableRules makeTableRules(const RuleConfig& config);
+
+// Reads "3:2", "6:5" or "1:1"
+bool parsePayout(const std::string& text, BlackjackPayout& payout);
+
+// One-line summary such as "S17, DAS, no surrender, blackjack pays 3:2"
+std::string describeRules(const RuleConfig& config);
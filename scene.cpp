@@ -0,0 +1,126 @@
+#include "scene.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Room left around a window shrunk to fit the desktop, for its frame and the taskbar
+const float DesktopMargin = 0.9f;
+
+sf::FloatRect tableViewport(const sf::Vector2u& windowSize) {
+    float fit = std::min(static_cast<float>(windowSize.x) / VirtualSize.x, static_cast<float>(windowSize.y) / VirtualSize.y);
+    float width = VirtualSize.x * fit;
+    float height = VirtualSize.y * fit;
+    // Whole-pixel offsets, so a scene rendered at the window's resolution is copied without resampling
+    return sf::FloatRect(std::floor((windowSize.x - width) / 2), std::floor((windowSize.y - height) / 2), width, height);
+}
+
+sf::Vector2u sceneResolution(const sf::Vector2u& windowSize, float renderScale) {
+    sf::FloatRect viewport = tableViewport(windowSize);
+    return sf::Vector2u(std::max(1u, static_cast<unsigned>(std::lround(viewport.width * renderScale))),
+        std::max(1u, static_cast<unsigned>(std::lround(viewport.height * renderScale))));
+}
+
+sf::Vector2f windowToVirtual(const sf::Vector2i& pixel, const sf::Vector2u& windowSize) {
+    sf::FloatRect viewport = tableViewport(windowSize);
+    if (viewport.width <= 0 || viewport.height <= 0) return sf::Vector2f(-1, -1); // Minimized
+    return sf::Vector2f((pixel.x - viewport.left) * VirtualSize.x / viewport.width,
+        (pixel.y - viewport.top) * VirtualSize.y / viewport.height);
+}
+
+sf::Vector2u initialWindowSize(const sf::Vector2u& desktopSize) {
+    if (desktopSize.x == 0 || desktopSize.y == 0) return VirtualSize;
+    float fit = std::min(1.0f, DesktopMargin * std::min(static_cast<float>(desktopSize.x) / VirtualSize.x,
+        static_cast<float>(desktopSize.y) / VirtualSize.y));
+    return sf::Vector2u(static_cast<unsigned>(VirtualSize.x * fit), static_cast<unsigned>(VirtualSize.y * fit));
+}
+
+// Adjust card positioning for dealer and player
+void adjustCardPositions(std::vector<sf::Vector2f>& dealerPositions, std::vector<sf::Vector2f>& playerPositions,
+    const Hand& dealerCards, const Hand& playerCards, const sf::Vector2u& windowSize) {
+    float cardSpacing = 100; // Space between cards
+
+    // Dealer cards centered
+    float dealerX = (windowSize.x - dealerCards.size() * cardSpacing) / 2.0f;
+    float dealerY = windowSize.y * 0.15f;
+
+    // Player cards centered
+    float playerX = (windowSize.x - playerCards.size() * cardSpacing) / 2.0f;
+    float playerY = windowSize.y * 0.55f;
+
+    dealerPositions.resize(dealerCards.size());
+    playerPositions.resize(playerCards.size());
+    for (size_t i = 0; i < dealerCards.size(); ++i) {
+        dealerPositions[i] = sf::Vector2f(dealerX + i * cardSpacing, dealerY);
+    }
+    for (size_t i = 0; i < playerCards.size(); ++i) {
+        playerPositions[i] = sf::Vector2f(playerX + i * cardSpacing, playerY);
+    }
+}
+
+// Queue a hand into this frame's card batch, resolving each card id to its atlas cell
+void appendCards(sf::VertexArray& cardVertices, const CardAtlas& atlas,
+    const Hand& cards, const std::vector<sf::Vector2f>& positions, bool holeCardDown) {
+    for (size_t i = 0; i < cards.size() && i < positions.size(); ++i) {
+        if (holeCardDown && i == 1) atlas.appendBack(cardVertices, positions[i]);
+        else atlas.appendCard(cardVertices, cards[i], positions[i]);
+    }
+}
+
+// Draw every queued card with a single draw call and start an empty batch
+void drawCardBatch(sf::RenderTarget& target, const CardAtlas& atlas, sf::VertexArray& cardVertices) {
+    ProfileScope scope(CardsPhase);
+    target.draw(cardVertices, &atlas.getTexture());
+    cardVertices.clear();
+}
+
+// Function to reset the game state
+void resetGame(Table& table,
+    std::vector<sf::Vector2f>& dealerPositions, std::vector<sf::Vector2f>& playerPositions, const sf::Vector2u& windowSize) {
+    table.deal();
+    adjustCardPositions(dealerPositions, playerPositions, table.dealerHand(), table.playerHand(), windowSize);
+}
+
+// Function to draw the round while a hit card is flying from the deck to the player
+void hitGetACard(sf::RenderTarget& target, const TableUi& ui, const CardAtlas& atlas, sf::VertexArray& cardVertices,
+    const Hand& dealerCards, const Hand& playerCards,
+    const std::vector<sf::Vector2f>& dealerPositions, const std::vector<sf::Vector2f>& playerPositions, bool gameOver,
+    const sf::Transformable& cardTop, const sf::Transformable& hitCard) {
+    {
+        ProfileScope scope(TablePhase);
+        ui.drawTable(target);
+    }
+
+    appendCards(cardVertices, atlas, dealerCards, dealerPositions, !gameOver);
+    appendCards(cardVertices, atlas, playerCards, playerPositions);
+    atlas.appendBack(cardVertices, cardTop.getPosition());
+    atlas.appendBack(cardVertices, hitCard.getPosition());
+    drawCardBatch(target, atlas, cardVertices);
+
+    ProfileScope scope(UiPhase);
+    ui.drawButtons(target, gameOver ? RoundOverLayer : PlayLayer);
+}
+
+// Function to draw the table, cards and buttons of a round in play
+void drawGameScene(sf::RenderTarget& target, const TableUi& ui, const CardAtlas& atlas, sf::VertexArray& cardVertices,
+    const Hand& dealerCards, const Hand& playerCards,
+    const std::vector<sf::Vector2f>& dealerPositions, const std::vector<sf::Vector2f>& playerPositions,
+    const sf::Transformable& cardTop, bool gameOver) {
+    {
+        ProfileScope scope(TablePhase);
+        ui.drawTable(target);
+    }
+
+    atlas.appendBack(cardVertices, cardTop.getPosition());
+    appendCards(cardVertices, atlas, dealerCards, dealerPositions, !gameOver);
+    appendCards(cardVertices, atlas, playerCards, playerPositions);
+    drawCardBatch(target, atlas, cardVertices);
+
+    ProfileScope scope(UiPhase);
+    ui.drawButtons(target, gameOver ? RoundOverLayer : PlayLayer);
+
+    ui.drawHint(target);
+
+    if (gameOver) {
+        ui.drawResult(target);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// Laying out and drawing the cards of a round. Kept apart from main so the benchmark can drive
+// the same code the window does.
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "card_atlas.hpp"
+#include "engine.hpp"
+#include "table.hpp"
+#include "ui.hpp"
+
+// Card artwork is shared by every copy of a card: the deck and hands only hold one-byte ids,
+// and the atlas cell for an id is looked up when the card is drawn
+const float CardScale = 0.15f; // Adjust for table layout
+
+// Everything on the table is laid out in this space, and the scene is scaled from it onto the window
+const sf::Vector2u VirtualSize(1920, 1080);
+
+// Largest rectangle with the virtual table's shape that fits the window, centred, in window pixels
+sf::FloatRect tableViewport(const sf::Vector2u& windowSize);
+
+// Pixel size the scene is rendered at: the table viewport times the render scale
+sf::Vector2u sceneResolution(const sf::Vector2u& windowSize, float renderScale);
+
+// A window pixel in virtual coordinates, for hit-testing the mouse
+sf::Vector2f windowToVirtual(const sf::Vector2i& pixel, const sf::Vector2u& windowSize);
+
+// Size the window opens at: the virtual size, shrunk to fit a smaller desktop
+sf::Vector2u initialWindowSize(const sf::Vector2u& desktopSize);
+
+// Adjust card positioning for dealer and player
+void adjustCardPositions(std::vector<sf::Vector2f>& dealerPositions, std::vector<sf::Vector2f>& playerPositions,
+    const Hand& dealerCards, const Hand& playerCards, const sf::Vector2u& windowSize);
+
+// Queue a hand into this frame's card batch, resolving each card id to its atlas cell.
+// With holeCardDown the second card shows its back, as the dealer's does until the round is over.
+void appendCards(sf::VertexArray& cardVertices, const CardAtlas& atlas,
+    const Hand& cards, const std::vector<sf::Vector2f>& positions, bool holeCardDown = false);
+
+// Draw every queued card with a single draw call and start an empty batch
+void drawCardBatch(sf::RenderTarget& target, const CardAtlas& atlas, sf::VertexArray& cardVertices);
+
+// Function to reset the game state
+void resetGame(Table& table,
+    std::vector<sf::Vector2f>& dealerPositions, std::vector<sf::Vector2f>& playerPositions, const sf::Vector2u& windowSize);
+
+// Function to draw the round while a hit card is flying from the deck to the player
+void hitGetACard(sf::RenderTarget& target, const TableUi& ui, const CardAtlas& atlas, sf::VertexArray& cardVertices,
+    const Hand& dealerCards, const Hand& playerCards,
+    const std::vector<sf::Vector2f>& dealerPositions, const std::vector<sf::Vector2f>& playerPositions, bool gameOver,
+    const sf::Transformable& cardTop, const sf::Transformable& hitCard);
+
+// Function to draw the table, cards and buttons of a round in play
+void drawGameScene(sf::RenderTarget& target, const TableUi& ui, const CardAtlas& atlas, sf::VertexArray& cardVertices,
+    const Hand& dealerCards, const Hand& playerCards,
+    const std::vector<sf::Vector2f>& dealerPositions, const std::vector<sf::Vector2f>& playerPositions,
+    const sf::Transformable& cardTop, bool gameOver);
@@ -0,0 +1,610 @@
+#include "server.hpp"
+#include "table.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <csignal>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using ServerClock = std::chrono::steady_clock;
+
+// How often the server prints its throughput
+const std::chrono::seconds StatsInterval(5);
+
+// Replies a connection may have waiting to be sent before the client is taken to have stopped reading
+const size_t MaxOutboxBytes = 1 << 20;
+
+static void putU16(std::uint8_t* out, std::uint16_t value) {
+    out[0] = static_cast<std::uint8_t>(value);
+    out[1] = static_cast<std::uint8_t>(value >> 8);
+}
+
+static void putU32(std::uint8_t* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+static std::uint16_t getU16(const std::uint8_t* in) {
+    return static_cast<std::uint16_t>(in[0] | (in[1] << 8));
+}
+
+static std::uint32_t getU32(const std::uint8_t* in) {
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<std::uint32_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+RequestBytes encodeRequest(const TableRequest& request) {
+    RequestBytes bytes = {};
+    bytes[0] = request.op;
+    putU32(&bytes[4], request.table);
+    return bytes;
+}
+
+TableRequest decodeRequest(const RequestBytes& bytes) {
+    return TableRequest{ bytes[0], getU32(&bytes[4]) };
+}
+
+ResponseBytes encodeResponse(const TableResponse& response) {
+    ResponseBytes bytes = {};
+    bytes[0] = response.status;
+    bytes[1] = response.state;
+    bytes[2] = response.outcome;
+    bytes[3] = response.newCardCount;
+    bytes[4] = response.newCards[0].id;
+    bytes[5] = response.newCards[1].id;
+    bytes[6] = response.dealerUpcard.id;
+    bytes[7] = response.dealerTotal;
+    bytes[8] = response.playerTotal;
+    putU16(&bytes[10], static_cast<std::uint16_t>(response.payoutTenths));
+    putU32(&bytes[12], response.table);
+    return bytes;
+}
+
+TableResponse decodeResponse(const ResponseBytes& bytes) {
+    TableResponse response;
+    response.status = bytes[0];
+    response.state = bytes[1];
+    response.outcome = bytes[2];
+    response.newCardCount = bytes[3];
+    response.newCards[0] = Card{ bytes[4] };
+    response.newCards[1] = Card{ bytes[5] };
+    response.dealerUpcard = Card{ bytes[6] };
+    response.dealerTotal = bytes[7];
+    response.playerTotal = bytes[8];
+    response.payoutTenths = static_cast<std::int16_t>(getU16(&bytes[10]));
+    response.table = getU32(&bytes[12]);
+    return response;
+}
+
+void LatencyHistogram::collect(std::vector<std::uint64_t>& total, bool reset) {
+    total.resize(LatencyBuckets);
+    for (int i = 0; i < LatencyBuckets; ++i) {
+        total[i] += reset ? counts[i].exchange(0, std::memory_order_relaxed) : counts[i].load(std::memory_order_relaxed);
+    }
+}
+
+long long latencyPercentile(const std::vector<std::uint64_t>& counts, double fraction) {
+    std::uint64_t samples = 0;
+    for (std::uint64_t count : counts) samples += count;
+    if (samples == 0) return 0;
+
+    std::uint64_t wanted = static_cast<std::uint64_t>(fraction * static_cast<double>(samples));
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen > wanted) return static_cast<long long>(i);
+    }
+    return static_cast<long long>(counts.size()) - 1;
+}
+
+#ifdef _WIN32
+
+int listenOn(const std::string&) {
+    std::cerr << "Error: the server needs POSIX sockets!" << std::endl;
+    return -1;
+}
+
+int connectTo(const std::string&) {
+    std::cerr << "Error: the server needs POSIX sockets!" << std::endl;
+    return -1;
+}
+
+bool sendAll(int, const std::uint8_t*, size_t) { return false; }
+bool receiveAll(int, std::uint8_t*, size_t) { return false; }
+void closeSocket(int) {}
+
+int runServer(const std::string& address, int, const ShoeConfig&, const RuleConfig&, std::uint64_t, const std::string&) {
+    return listenOn(address);
+}
+
+#else
+
+// "tcp:<port>" binds loopback only, anything else is a Unix socket path
+static bool isTcpAddress(const std::string& address, int& port) {
+    if (address.compare(0, 4, "tcp:") != 0) return false;
+    port = std::atoi(address.c_str() + 4);
+    return true;
+}
+
+int listenOn(const std::string& address) {
+    int port = 0;
+    int fd = -1;
+    if (isTcpAddress(address, port)) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "Error binding " << address << "!" << std::endl;
+            closeSocket(fd);
+            return -1;
+        }
+    }
+    else {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (address.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Error: socket path " << address << " is too long!" << std::endl;
+            return -1;
+        }
+        address.copy(addr.sun_path, address.size());
+        unlink(address.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "Error binding " << address << "!" << std::endl;
+            closeSocket(fd);
+            return -1;
+        }
+    }
+
+    if (listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "Error listening on " << address << "!" << std::endl;
+        closeSocket(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int connectTo(const std::string& address) {
+    int port = 0;
+    int fd = -1;
+    bool connected = false;
+    if (isTcpAddress(address, port)) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        connected = fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+
+        // Small messages go out right away instead of waiting to be coalesced
+        int yes = 1;
+        if (connected) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    }
+    else {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        address.copy(addr.sun_path, std::min(address.size(), sizeof(addr.sun_path) - 1));
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        connected = fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    if (!connected) {
+        std::cerr << "Error connecting to " << address << "!" << std::endl;
+        closeSocket(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int socket, const std::uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(socket, data, size, 0);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool receiveAll(int socket, std::uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t received = recv(socket, data, size, 0);
+        if (received <= 0) return false;
+        data += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+void closeSocket(int socket) {
+    if (socket >= 0) close(socket);
+}
+
+static std::atomic<bool> serverStopping(false);
+
+static void stopServer(int) {
+    serverStopping = true;
+}
+
+// One client socket. Workers only queue replies on it, its own writer thread sends them, so a client
+// that stops reading backs up its own outbox and never a worker. One that lets the outbox fill is cut off.
+struct Connection {
+    Connection(int socket, std::uint64_t id) : socket(socket), id(id) {}
+    ~Connection() { closeSocket(socket); }
+
+    void reply(const TableResponse& response) {
+        ResponseBytes bytes = encodeResponse(response);
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        if (closing) return;
+        if (outbox.size() + bytes.size() > MaxOutboxBytes) {
+            // Wakes the reader out of its receive too, which then closes the client's tables
+            shutdown(socket, SHUT_RDWR);
+            closing = true;
+            outbox.clear();
+        }
+        else {
+            outbox.insert(outbox.end(), bytes.begin(), bytes.end());
+        }
+        wake.notify_one();
+    }
+
+    // Runs on the writer thread until close() and everything queued before it is sent
+    void writeReplies() {
+        std::vector<std::uint8_t> sending;
+        std::unique_lock<std::mutex> lock(outboxMutex);
+        while (true) {
+            wake.wait(lock, [this]() { return closing || !outbox.empty(); });
+            if (outbox.empty()) return;
+            sending.swap(outbox);
+            lock.unlock();
+            bool sent = sendAll(socket, sending.data(), sending.size());
+            sending.clear();
+            lock.lock();
+            if (!sent) {
+                closing = true;
+                outbox.clear();
+            }
+        }
+    }
+
+    // Stop taking replies, the writer returns once the queued ones are out
+    void close() {
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        closing = true;
+        wake.notify_one();
+    }
+
+    int socket;
+    std::uint64_t id; // Never reused, unlike the address of a freed connection
+    std::atomic<bool> finished{ false }; // Its reader has returned and can be joined
+
+    std::mutex outboxMutex;
+    std::condition_variable wake;
+    std::vector<std::uint8_t> outbox; // Encoded replies not yet handed to the socket
+    bool closing = false;
+};
+
+// An action waiting for its table, with when it came off the socket
+struct PendingAction {
+    std::uint8_t op;
+    std::shared_ptr<Connection> connection;
+    std::uint64_t owner; // Connection that queued it, checked again when it runs
+    ServerClock::time_point received;
+};
+
+// A table and the actions queued for it. At most one pool task works through the queue at a time,
+// so a table's actions run in the order they arrived without ever blocking a worker.
+struct TableSlot {
+    std::mutex mutex;
+    std::unique_ptr<Table> table;
+    std::uint64_t owner = 0; // Id of the connection that opened it, 0 while closed
+    std::deque<PendingAction> pending;
+    bool scheduled = false;
+};
+
+class TableServer {
+public:
+    TableServer(int maxTables, const ShoeConfig& shoeConfig, const RuleConfig& rules, std::uint64_t seed,
+        HandLogWriter* log)
+        : slots(maxTables), shoeConfig(shoeConfig), rules(rules), seed(seed), log(log), openTables(0), decisions(0),
+          latencies(std::max(1u, std::thread::hardware_concurrency())), pool(static_cast<unsigned>(latencies.size())) {
+        for (int i = maxTables - 1; i >= 0; --i) {
+            freeSlots.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    // Reads one connection's requests until it hangs up, then closes the tables it left open
+    void serveConnection(std::shared_ptr<Connection> connection) {
+        std::thread writer(&Connection::writeReplies, connection.get());
+        std::vector<std::uint32_t> owned;
+        RequestBytes bytes;
+        while (receiveAll(connection->socket, bytes.data(), bytes.size())) {
+            TableRequest request = decodeRequest(bytes);
+            if (request.op == OpenTable) {
+                openTable(connection, owned);
+            }
+            else if (request.op >= DealRound && request.op <= CloseTable) {
+                queueAction(connection, request, connection->id);
+                if (request.op == CloseTable) {
+                    owned.erase(std::remove(owned.begin(), owned.end(), request.table), owned.end());
+                }
+            }
+            else {
+                connection->reply(rejection(StatusBadOp, request.table));
+            }
+        }
+
+        // Nobody is left to hear the replies, so the closes carry no connection. A client that only
+        // closed its own end wouldn't read them either, so the socket is shut down before the writer is
+        // waited on, in case it is stuck in a send.
+        for (std::uint32_t id : owned) {
+            queueAction(nullptr, TableRequest{ CloseTable, id }, connection->id);
+        }
+        shutdown(connection->socket, SHUT_RDWR);
+        connection->close();
+        writer.join();
+        connection->finished = true;
+    }
+
+    // Decisions since the last report, and the action latency percentiles over the same period
+    void report(std::chrono::duration<double> elapsed) {
+        std::vector<std::uint64_t> counts;
+        for (auto& histogram : latencies) histogram.collect(counts, true);
+        long long decided = decisions.exchange(0);
+
+        std::cout << openTables.load() << " tables, " << static_cast<long long>(decided / elapsed.count())
+            << " decisions/s, action latency p50 " << latencyPercentile(counts, 0.5) << " us, p99 "
+            << latencyPercentile(counts, 0.99) << " us" << std::endl;
+    }
+
+private:
+    static TableResponse rejection(ResponseStatus status, std::uint32_t table) {
+        TableResponse response = {};
+        response.status = static_cast<std::uint8_t>(status);
+        response.table = table;
+        return response;
+    }
+
+    void openTable(const std::shared_ptr<Connection>& connection, std::vector<std::uint32_t>& owned) {
+        std::uint32_t id;
+        {
+            std::lock_guard<std::mutex> lock(freeMutex);
+            if (freeSlots.empty()) {
+                connection->reply(rejection(StatusFull, 0));
+                return;
+            }
+            id = freeSlots.back();
+            freeSlots.pop_back();
+        }
+
+        // Each table deals from its own stream of the session seed
+        TableSlot& slot = slots[id];
+        {
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            slot.table = std::make_unique<Table>(shoeConfig, rules, seed, id);
+            slot.table->setLog(log);
+            slot.owner = connection->id;
+        }
+        owned.push_back(id);
+        openTables++;
+
+        TableResponse response = rejection(StatusOk, id);
+        response.state = WaitingForDeal;
+        connection->reply(response);
+    }
+
+    void queueAction(const std::shared_ptr<Connection>& connection, const TableRequest& request, std::uint64_t owner) {
+        if (request.table >= slots.size()) {
+            if (connection) connection->reply(rejection(StatusBadTable, request.table));
+            return;
+        }
+
+        TableSlot& slot = slots[request.table];
+        bool schedule = false;
+        {
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            if (slot.owner != owner) {
+                if (connection) connection->reply(rejection(StatusBadTable, request.table));
+                return;
+            }
+            slot.pending.push_back(PendingAction{ request.op, connection, owner, ServerClock::now() });
+            schedule = !slot.scheduled;
+            slot.scheduled = true;
+        }
+
+        if (schedule) {
+            std::uint32_t id = request.table;
+            pool.submit([this, id]() { runTable(id); });
+        }
+    }
+
+    // Work through the table's queue, replying to each action as it is taken
+    void runTable(std::uint32_t id) {
+        TableSlot& slot = slots[id];
+        LatencyHistogram& histogram = latencies[pool.currentWorker()];
+
+        while (true) {
+            PendingAction action;
+            TableResponse response;
+            {
+                std::lock_guard<std::mutex> lock(slot.mutex);
+                if (slot.pending.empty()) {
+                    slot.scheduled = false;
+                    return;
+                }
+                action = std::move(slot.pending.front());
+                slot.pending.pop_front();
+                response = takeAction(slot, id, action);
+            }
+
+            if (action.connection) {
+                action.connection->reply(response);
+                histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                    ServerClock::now() - action.received).count());
+            }
+        }
+    }
+
+    // Called with the slot locked. Actions queued behind a close may find the slot reopened by another
+    // connection by the time they run, so ownership is checked again here.
+    TableResponse takeAction(TableSlot& slot, std::uint32_t id, const PendingAction& action) {
+        if (!slot.table || slot.owner != action.owner) return rejection(StatusBadTable, id);
+        Table& table = *slot.table;
+        std::uint8_t op = action.op;
+
+        if (op == CloseTable) {
+            slot.table.reset();
+            slot.owner = 0;
+            openTables--;
+            std::lock_guard<std::mutex> lock(freeMutex);
+            freeSlots.push_back(id);
+            return rejection(StatusOk, id);
+        }
+
+        size_t cardsBefore = table.playerHand().size();
+        bool taken = op == DealRound ? table.deal() : op == HitCard ? table.hit() : table.stand();
+        if (!taken) return rejection(StatusNotAllowed, id);
+        if (op != DealRound) decisions++;
+
+        const Hand& dealer = table.dealerHand();
+        const Hand& player = table.playerHand();
+        TableResponse response = rejection(StatusOk, id);
+        response.state = static_cast<std::uint8_t>(table.state());
+        if (op == DealRound) cardsBefore = 0;
+        for (size_t i = cardsBefore; i < player.size() && response.newCardCount < 2; ++i) {
+            response.newCards[response.newCardCount++] = player[i];
+        }
+        response.dealerUpcard = dealer.front();
+        response.playerTotal = static_cast<std::uint8_t>(player.total());
+        if (table.state() == RoundOver) {
+            response.outcome = static_cast<std::uint8_t>(table.result().outcome);
+            response.dealerTotal = static_cast<std::uint8_t>(dealer.total());
+            response.payoutTenths = static_cast<std::int16_t>(std::lround(table.result().payout * 10));
+        }
+        else {
+            response.dealerTotal = static_cast<std::uint8_t>(cardValue(dealer.front()));
+        }
+        return response;
+    }
+
+    std::vector<TableSlot> slots;
+    std::mutex freeMutex;
+    std::vector<std::uint32_t> freeSlots;
+
+    ShoeConfig shoeConfig;
+    RuleConfig rules;
+    std::uint64_t seed;
+    HandLogWriter* log;
+
+    std::atomic<int> openTables;
+    std::atomic<long long> decisions;
+
+    // One per worker, so recording never contends
+    std::vector<LatencyHistogram> latencies;
+
+    // Last, so it finishes the queued actions before anything they touch goes away
+    WorkStealingPool pool;
+};
+
+int runServer(const std::string& address, int maxTables, const ShoeConfig& shoeConfig, const RuleConfig& rules,
+    std::uint64_t seed, const std::string& logPath) {
+    // Tables log to the writer, so it opens first and closes last
+    HandLogWriter handLog;
+    if (!logPath.empty() && !handLog.open(logPath)) return -1;
+
+    int listener = listenOn(address);
+    if (listener < 0) return -1;
+
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    // A client hanging up mid-reply shows up as a failed send instead
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Serving up to " << maxTables << " tables on " << address << " (" << describeRules(rules)
+        << ", seed " << seed << ")" << std::endl;
+
+    // A reader thread per connection, holding on to the connection until the thread is joined
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<Connection> connection;
+    };
+    std::vector<Reader> readers;
+    std::uint64_t nextConnectionId = 1;
+    {
+        TableServer server(maxTables, shoeConfig, rules, seed, handLog.isOpen() ? &handLog : nullptr);
+        auto lastReport = ServerClock::now();
+
+        // Accept with a timeout, so the stop flag and the report timer are both noticed
+        while (!serverStopping) {
+            pollfd listening = { listener, POLLIN, 0 };
+            if (poll(&listening, 1, 200) > 0) {
+                int client = accept(listener, nullptr, nullptr);
+                int port = 0;
+                int yes = 1;
+                if (client >= 0 && isTcpAddress(address, port)) {
+                    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                }
+                if (client >= 0) {
+                    auto connection = std::make_shared<Connection>(client, nextConnectionId++);
+                    readers.push_back(Reader{ std::thread(&TableServer::serveConnection, &server, connection), connection });
+                }
+            }
+
+            // Join the readers of connections that have hung up, bots reconnect all day on a long run
+            for (size_t i = 0; i < readers.size();) {
+                if (readers[i].connection->finished) {
+                    readers[i].thread.join();
+                    readers[i] = std::move(readers.back());
+                    readers.pop_back();
+                }
+                else {
+                    ++i;
+                }
+            }
+
+            auto now = ServerClock::now();
+            if (now - lastReport >= StatsInterval) {
+                server.report(now - lastReport);
+                lastReport = now;
+            }
+        }
+
+        // Wake the readers out of their receives, then let the pool finish what was queued
+        for (auto& reader : readers) shutdown(reader.connection->socket, SHUT_RDWR);
+        for (auto& reader : readers) reader.thread.join();
+        server.report(ServerClock::now() - lastReport);
+    }
+
+    closeSocket(listener);
+    int port = 0;
+    if (!isTcpAddress(address, port)) unlink(address.c_str());
+    std::cout << "Server stopped" << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+
+// Headless multi-table server, run with `blackjack --serve <address>`, and the bot clients that load it,
+// run with `blackjack --bots <address>`. The address is a Unix socket path or "tcp:<port>" for loopback TCP.
+//
+// Every message has a fixed size and little-endian fields, and a connection can have many requests in flight.
+// Request, 8 bytes:   op, 3 reserved, table id (u32)
+// Response, 16 bytes: status, table state, outcome, new card count, new player cards (2), dealer upcard,
+//                     dealer total, player total, reserved, payout in tenths of a bet (i16), table id (u32)
+// Open is answered before the next request on the connection is read, so a client can open tables one by
+// one and learn their ids. Requests for one table are answered in order, across tables in any order.
+
+#include "engine.hpp"
+#include "rules.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum TableOp {
+    OpenTable = 1,
+    DealRound,
+    HitCard,
+    StandHand,
+    CloseTable
+};
+
+enum ResponseStatus {
+    StatusOk,
+    StatusBadTable,     // No open table with that id on this connection
+    StatusNotAllowed,   // The action doesn't fit the table's state
+    StatusBadOp,
+    StatusFull          // Out of tables
+};
+
+const size_t RequestSize = 8;
+const size_t ResponseSize = 16;
+
+using RequestBytes = std::array<std::uint8_t, RequestSize>;
+using ResponseBytes = std::array<std::uint8_t, ResponseSize>;
+
+struct TableRequest {
+    std::uint8_t op;
+    std::uint32_t table;
+};
+
+struct TableResponse {
+    std::uint8_t status;
+    std::uint8_t state;         // TableState
+    std::uint8_t outcome;       // Outcome, once the round is over
+    std::uint8_t newCardCount;  // Cards the action gave the player: 2 on a deal, 1 on a hit
+    Card newCards[2];
+    Card dealerUpcard;
+    std::uint8_t dealerTotal;   // Only the upcard counts until the round is over
+    std::uint8_t playerTotal;
+    std::int16_t payoutTenths;  // Net result of the round, so 15 is a 3:2 blackjack
+    std::uint32_t table;
+};
+
+RequestBytes encodeRequest(const TableRequest& request);
+TableRequest decodeRequest(const RequestBytes& bytes);
+ResponseBytes encodeResponse(const TableResponse& response);
+TableResponse decodeResponse(const ResponseBytes& bytes);
+
+// Latencies in 1 microsecond buckets, the last bucket takes everything slower.
+// Counts are relaxed atomics so one thread can read them while another records.
+const int LatencyBuckets = 16384;
+
+struct LatencyHistogram {
+    std::array<std::atomic<std::uint32_t>, LatencyBuckets> counts{};
+
+    void record(long long micros) {
+        int bucket = micros < 0 ? 0 : micros >= LatencyBuckets ? LatencyBuckets - 1 : static_cast<int>(micros);
+        counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Add the counts to a running total, and start over when asked
+    void collect(std::vector<std::uint64_t>& total, bool reset);
+};
+
+// Latency in microseconds below which the given fraction of the samples fall
+long long latencyPercentile(const std::vector<std::uint64_t>& counts, double fraction);
+
+// Socket plumbing shared by the server and the bots, -1 on failure
+int listenOn(const std::string& address);
+int connectTo(const std::string& address);
+bool sendAll(int socket, const std::uint8_t* data, size_t size);
+bool receiveAll(int socket, std::uint8_t* data, size_t size);
+void closeSocket(int socket);
+
+// Serve until interrupted, printing decisions per second and action latency every few seconds.
+// Every finished round goes to the hand log when a path is given.
+int runServer(const std::string& address, int maxTables, const ShoeConfig& shoeConfig, const RuleConfig& rules,
+    std::uint64_t seed, const std::string& logPath);
+
+// Connect one bot per core, each playing its share of the tables with the fixed strategy for the given time,
+// then print decisions per second and round-trip latency
+int runLoadTest(const std::string& address, int tables, int seconds);
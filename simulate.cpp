@@ -0,0 +1,113 @@
+#include "simulate.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Hands are played in fixed batches, each from its own RNG stream and fresh shoe.
+// The totals then only depend on the seed, not on how many threads picked up the work.
+const long long HandsPerBatch = 1 << 16;
+
+// Totals gathered by a single simulation thread
+struct SimulationTally {
+    long long playerWins = 0;
+    long long dealerWins = 0;
+    long long ties = 0;
+    double payout = 0;   // Net units won by the player
+};
+
+// Built once per rule variant, so the per-hand loop carries no rule checks
+template <typename R>
+static SimulationTally simulateBatch(long long batch, long long hands, const ShoeConfig& shoeConfig, std::uint64_t seed) {
+    SimulationTally tally;
+    Rng rng(seed, static_cast<std::uint64_t>(batch));
+    Shoe shoe(shoeConfig);
+    shoe.shuffle(rng);
+
+    for (long long i = 0; i < hands; ++i) {
+        if (shoe.needsShuffle()) shoe.shuffle(rng);
+
+        RoundResult result = playRound<R>(shoe, rng);
+        tally.payout += result.payout;
+        switch (result.outcome) {
+        case PlayerWins: tally.playerWins++; break;
+        case DealerWins: tally.dealerWins++; break;
+        default: tally.ties++; break;
+        }
+    }
+    return tally;
+}
+
+static void addTally(SimulationTally& total, const SimulationTally& tally) {
+    total.playerWins += tally.playerWins;
+    total.dealerWins += tally.dealerWins;
+    total.ties += tally.ties;
+    total.payout += tally.payout;
+}
+
+// Each thread keeps taking the next batch until all hands are played. Counting happens in locals, the
+// threads' tallies sit next to each other in memory and are only written once, at the end.
+template <typename R>
+static void simulateHands(std::atomic<long long>& nextBatch, long long hands, const ShoeConfig& shoeConfig,
+    std::uint64_t seed, SimulationTally& tally) {
+    SimulationTally total;
+    long long batchCount = (hands + HandsPerBatch - 1) / HandsPerBatch;
+    for (long long batch = nextBatch++; batch < batchCount; batch = nextBatch++) {
+        long long batchHands = std::min(HandsPerBatch, hands - batch * HandsPerBatch);
+        addTally(total, simulateBatch<R>(batch, batchHands, shoeConfig, seed));
+    }
+    tally = total;
+}
+
+template <typename R>
+static int runSimulation(long long hands, const ShoeConfig& shoeConfig, const RuleConfig& rules, std::uint64_t seed) {
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<SimulationTally> tallies(threadCount);
+    std::vector<std::thread> workers;
+    std::atomic<long long> nextBatch(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back(simulateHands<R>, std::ref(nextBatch), hands, std::cref(shoeConfig), seed, std::ref(tallies[t]));
+    }
+    for (auto& worker : workers) worker.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    SimulationTally total;
+    for (const auto& tally : tallies) {
+        addTally(total, tally);
+    }
+
+    // Doubles, splits, surrenders and blackjacks all show up in the net payout
+    double handCount = static_cast<double>(hands);
+    double houseEdge = -total.payout / handCount;
+
+    // The penetration the shoe actually deals to, which always leaves the opening deal behind the cut card
+    Shoe shoe(shoeConfig);
+    std::cout << "Simulated " << hands << " hands from a " << shoe.deckCount() << "-deck shoe ("
+        << 100.0 * shoe.cutCardPosition() / shoe.size() << "% penetration, cut card at " << shoe.cutCardPosition()
+        << " of " << shoe.size() << ") on " << threadCount << " threads in " << elapsed.count() << " s" << std::endl;
+    std::cout << "Rules: " << describeRules(rules) << std::endl;
+    std::cout << "Seed: " << seed << std::endl;
+    std::cout << "Throughput: " << static_cast<long long>(handCount / elapsed.count()) << " hands/sec" << std::endl;
+    std::cout << "Player wins: " << 100.0 * total.playerWins / handCount << "%, "
+        << "Dealer wins: " << 100.0 * total.dealerWins / handCount << "%, "
+        << "Ties: " << 100.0 * total.ties / handCount << "%" << std::endl;
+    std::cout << "House edge: " << 100.0 * houseEdge << "%" << std::endl;
+    return 0;
+}
+
+int runSimulation(long long hands, const ShoeConfig& shoeConfig, const RuleConfig& rules, std::uint64_t seed) {
+    if (hands <= 0) {
+        std::cerr << "Number of hands to simulate must be positive!" << std::endl;
+        return -1;
+    }
+
+    return dispatchRules(rules, [&](auto variant) {
+        return runSimulation<decltype(variant)>(hands, shoeConfig, rules, seed);
+    });
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Headless Monte Carlo mode, run with `blackjack --simulate N`
+
+#include "engine.hpp"
+#include "rules.hpp"
+#include <cstdint>
+
+// Plays the given number of hands across all cores and prints throughput and house edge.
+// The same seed always reproduces the same results.
+int runSimulation(long long hands, const ShoeConfig& shoeConfig, const RuleConfig& rules, std::uint64_t seed);
@@ -0,0 +1,165 @@
+#include "sound_effects.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static const char* const EffectNames[SoundEffectCount] = { "deal", "flip", "win", "lose", "bust", "push" };
+
+const unsigned SampleRate = 44100;
+const double Pi = 3.14159265358979323846;
+
+// Mix a decaying tone into the samples, gliding from one pitch to another. A 2 ms fade-in keeps it from clicking.
+static void addTone(std::vector<float>& samples, double start, double seconds, double fromHz, double toHz,
+    double volume, double decay) {
+    size_t first = static_cast<size_t>(start * SampleRate);
+    size_t count = static_cast<size_t>(seconds * SampleRate);
+    if (samples.size() < first + count) samples.resize(first + count, 0.0f);
+
+    double phase = 0;
+    for (size_t i = 0; i < count; ++i) {
+        double t = static_cast<double>(i) / SampleRate;
+        phase += 2 * Pi * (fromHz + (toHz - fromHz) * i / count) / SampleRate;
+        double envelope = std::exp(-decay * t) * std::min(1.0, t / 0.002);
+        samples[first + i] += static_cast<float>(volume * envelope * std::sin(phase));
+    }
+}
+
+// Mix in a burst of softened white noise, the sound of card stock
+static void addNoise(std::vector<float>& samples, double start, double seconds, double volume, double decay) {
+    size_t first = static_cast<size_t>(start * SampleRate);
+    size_t count = static_cast<size_t>(seconds * SampleRate);
+    if (samples.size() < first + count) samples.resize(first + count, 0.0f);
+
+    std::minstd_rand rng(static_cast<unsigned>(count));
+    std::uniform_real_distribution<double> white(-1.0, 1.0);
+    double last = 0;
+    for (size_t i = 0; i < count; ++i) {
+        double t = static_cast<double>(i) / SampleRate;
+        last = 0.6 * last + 0.4 * white(rng);
+        samples[first + i] += static_cast<float>(volume * std::exp(-decay * t) * std::min(1.0, t / 0.002) * last);
+    }
+}
+
+// Built-in sound of an effect, used when there's no file for it
+static std::vector<float> synthesize(SoundEffect effect) {
+    std::vector<float> samples;
+    switch (effect) {
+    case DealSound:
+        addNoise(samples, 0, 0.08, 0.8, 45);
+        break;
+    case FlipSound:
+        addNoise(samples, 0, 0.03, 0.7, 120);
+        addTone(samples, 0, 0.03, 1800, 1400, 0.2, 150);
+        break;
+    case WinSound:
+        addTone(samples, 0, 0.25, 660, 660, 0.35, 10);
+        addTone(samples, 0.1, 0.35, 880, 880, 0.35, 8);
+        break;
+    case LoseSound:
+        addTone(samples, 0, 0.35, 330, 220, 0.4, 6);
+        break;
+    case BustSound:
+        addTone(samples, 0, 0.3, 150, 90, 0.45, 8);
+        addTone(samples, 0, 0.3, 300, 180, 0.15, 8);
+        break;
+    case PushSound:
+        addTone(samples, 0, 0.15, 440, 440, 0.3, 20);
+        break;
+    default:
+        break;
+    }
+    return samples;
+}
+
+SoundEffects::SoundEffects() : played(0), timed(0), stolen(0) {
+    triggeredAt.fill(0);
+    voiceEffect.fill(-1);
+    timing.fill(false);
+    latencies.fill(0.0f);
+}
+
+void SoundEffects::load() {
+    for (int effect = 0; effect < SoundEffectCount; ++effect) {
+        std::string path = std::string("audio/") + EffectNames[effect] + ".wav";
+        if (std::ifstream(path).good() && buffers[effect].loadFromFile(path)) continue;
+
+        std::vector<float> mixed = synthesize(static_cast<SoundEffect>(effect));
+        std::vector<std::int16_t> samples(mixed.size());
+        for (size_t i = 0; i < mixed.size(); ++i) {
+            samples[i] = static_cast<std::int16_t>(std::max(-1.0f, std::min(1.0f, mixed[i])) * 32767);
+        }
+        if (!buffers[effect].loadFromSamples(samples.data(), samples.size(), 1, SampleRate)) {
+            std::cerr << "Error creating sound effect: " << EffectNames[effect] << std::endl;
+        }
+    }
+}
+
+void SoundEffects::play(SoundEffect effect) {
+    std::int64_t now = profileClock();
+
+    // A free voice, or else the one that started longest ago
+    int voice = -1;
+    int oldest = 0;
+    for (int v = 0; v < VoiceCount && voice < 0; ++v) {
+        if (voices[v].getStatus() == sf::SoundSource::Stopped) voice = v;
+        else if (triggeredAt[v] < triggeredAt[oldest]) oldest = v;
+    }
+    if (voice < 0) {
+        voice = oldest;
+        ++stolen;
+    }
+
+    // setBuffer registers the voice with the buffer, which allocates, so a voice keeps its buffer while
+    // it plays the same effect. Stopping first restarts an effect that is still playing.
+    voices[voice].stop();
+    if (voiceEffect[voice] != effect) {
+        voices[voice].setBuffer(buffers[effect]);
+        voiceEffect[voice] = effect;
+    }
+    voices[voice].play();
+    triggeredAt[voice] = now;
+    timing[voice] = true;
+    ++played;
+}
+
+void SoundEffects::update() {
+    std::int64_t now = profileClock();
+    for (int v = 0; v < VoiceCount; ++v) {
+        if (!timing[v]) continue;
+        if (voices[v].getStatus() == sf::SoundSource::Stopped) {
+            timing[v] = false; // Over before it could be timed
+            continue;
+        }
+
+        // The mixer has started taking samples. The effect became audible the played offset before now,
+        // give or take the device's own output buffer, which OpenAL doesn't report.
+        sf::Time offset = voices[v].getPlayingOffset();
+        if (offset == sf::Time::Zero) continue;
+        double latency = (now - triggeredAt[v]) / 1e6 - offset.asSeconds() * 1000.0;
+        latencies[timed % LatencySamples] = static_cast<float>(std::max(0.0, latency));
+        ++timed;
+        timing[v] = false;
+    }
+}
+
+bool SoundEffects::isTiming() const {
+    return std::find(timing.begin(), timing.end(), true) != timing.end();
+}
+
+void SoundEffects::report() const {
+    if (played == 0) return;
+
+    std::cout << "Sound effects: " << played << " played, " << stolen << " cut short for a newer one";
+    if (timed > 0) {
+        std::vector<float> sorted(latencies.begin(), latencies.begin() + std::min<long long>(timed, LatencySamples));
+        std::sort(sorted.begin(), sorted.end());
+        std::cout << ", trigger to audible median " << sorted[sorted.size() / 2] << " ms, max " << sorted.back()
+            << " ms over the last " << sorted.size();
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Sound effects for the table. Every effect is decoded once up front, and plays on one of a fixed set
+// of voices, taking over the oldest voice when all of them are busy. A voice only gets a new buffer when
+// it last played a different effect, so a burst of the same effects doesn't decode or allocate. Music streams separately through sf::Music.
+
+#include <SFML/Audio.hpp>
+#include <array>
+#include <cstdint>
+
+enum SoundEffect {
+    DealSound,  // A card lands on the table
+    FlipSound,  // The dealer's hole card turns over
+    WinSound,
+    LoseSound,
+    BustSound,
+    PushSound,
+    SoundEffectCount
+};
+
+class SoundEffects {
+public:
+    // Voices that can play at once
+    static const int VoiceCount = 16;
+
+    SoundEffects();
+
+    // Load every effect. audio/<name>.wav replaces the built-in sound of an effect when it exists.
+    void load();
+
+    void play(SoundEffect effect);
+
+    // Time the voices that have become audible since the last call. Every frame, and keep calling it
+    // while isTiming() even when there is nothing to draw, or effects played just before going idle are missed.
+    void update();
+    bool isTiming() const;
+
+    // Print how many effects played and how long they took from play() to being heard
+    void report() const;
+
+private:
+    // Trigger-to-audible times of the most recent effects, in milliseconds
+    static const int LatencySamples = 1024;
+
+    std::array<sf::SoundBuffer, SoundEffectCount> buffers;
+    std::array<sf::Sound, VoiceCount> voices;
+    std::array<int, VoiceCount> voiceEffect;          // Effect whose buffer the voice holds, -1 for none
+    std::array<std::int64_t, VoiceCount> triggeredAt; // profileClock() at play
+    std::array<bool, VoiceCount> timing;              // Played but not yet heard
+
+    std::array<float, LatencySamples> latencies;
+    long long played;
+    long long timed;
+    long long stolen;
+};
@@ -0,0 +1,468 @@
+#include "strategy.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+const int DealerBust = 5;
+
+// Slots in the dealer scratch table, well above the distinct dealer hands from any upcard
+const int ScratchBits = 13;
+const int ScratchSize = 1 << ScratchBits;
+
+// Bits each value takes up in a composition key, a hand never holds 32 cards of one value
+const int KeyBitsPerValue = 5;
+
+// Split hands share compositions with unsplit ones, so their memo entries carry the split value from this bit on
+const int SplitTagShift = 56;
+
+const char* const ActionNames[ActionCount] = { "stand", "hit", "double", "split" };
+
+// Column order of the chart: 2-9, ten, then ace
+const int ChartColumns[ValueCount] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 0 };
+const char ValueLabels[ValueCount] = { 'A', '2', '3', '4', '5', '6', '7', '8', '9', 'T' };
+
+static int pointValue(int value) {
+    return value == 0 ? 1 : value + 1;
+}
+
+static std::uint64_t keyUnit(int value) {
+    return std::uint64_t(1) << (KeyBitsPerValue * value);
+}
+
+// Best total of a hand, counting one ace as 11 when that doesn't bust it
+static int bestTotal(int hardTotal, bool hasAce) {
+    return hasAce && hardTotal + 10 <= 21 ? hardTotal + 10 : hardTotal;
+}
+
+static Action bestAction(const std::array<double, ActionCount>& ev) {
+    return static_cast<Action>(std::max_element(ev.begin(), ev.end()) - ev.begin());
+}
+
+ValueCounts shoeCounts(int decks) {
+    ValueCounts counts;
+    counts.fill(SuitCount * decks);
+    counts[9] = 4 * SuitCount * decks; // Ten, jack, queen and king
+    return counts;
+}
+
+ValueCounts handCounts(const Hand& hand) {
+    ValueCounts counts{};
+    for (Card card : hand) counts[valueIndex(card)]++;
+    return counts;
+}
+
+// Hole card that would give the dealer blackjack under an upcard, -1 when none can
+static int naturalHole(int upcard) {
+    return upcard == 0 ? 9 : upcard == 9 ? 0 : -1;
+}
+
+StrategySolver::StrategySolver(const ValueCounts& fullShoe, int upcard, const RuleConfig& rules)
+    : shoe(fullShoe), upcard(upcard), rules(rules), cancelFlag(nullptr), stopped(false), dealerScratch(ScratchSize, ScratchSlot{ 0, 0, {} }), scratchGeneration(0), scratchUsed(0) {
+    shoe[upcard]--;
+    remaining = 0;
+    for (int count : shoe) remaining += count;
+}
+
+HandEv StrategySolver::evaluate(const ValueCounts& hand, bool canDouble, bool canSplit) {
+    int hardTotal = 0, cards = 0;
+    std::uint64_t removed = 0;
+    for (int v = 0; v < ValueCount; ++v) {
+        shoe[v] -= hand[v];
+        remaining -= hand[v];
+        hardTotal += hand[v] * pointValue(v);
+        cards += hand[v];
+        removed += hand[v] * keyUnit(v);
+    }
+    bool hasAce = hand[0] > 0;
+    stopped = false;
+
+    HandEv result;
+    result.ev.fill(NotAllowed);
+    if (hardTotal > 21) {
+        result.ev[Stand] = -1.0;
+    }
+    else {
+        result.ev[Stand] = standEv(hardTotal, hasAce, removed);
+        result.ev[Hit] = hitEv(hardTotal, hasAce, removed, 0);
+        if (canDouble && cards == 2) {
+            result.ev[Double] = doubleEv(hardTotal, hasAce, removed);
+        }
+        if (canSplit && cards == 2) {
+            for (int v = 0; v < ValueCount; ++v) {
+                if (hand[v] == 2) result.ev[Split] = splitEv(v, removed);
+            }
+        }
+    }
+    result.best = bestAction(result.ev);
+
+    for (int v = 0; v < ValueCount; ++v) {
+        shoe[v] += hand[v];
+        remaining += hand[v];
+    }
+    return result;
+}
+
+void StrategySolver::setCancelFlag(const std::atomic<bool>* flag) {
+    cancelFlag = flag;
+}
+
+bool StrategySolver::interrupted() const {
+    return stopped;
+}
+
+bool StrategySolver::shouldStop() {
+    if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) stopped = true;
+    return stopped;
+}
+
+const StrategySolver::DealerOdds& StrategySolver::dealerOdds(std::uint64_t removed) {
+    auto found = dealerMemo.find(removed);
+    if (found != dealerMemo.end()) return found->second;
+
+    // Each new set of dealer odds is the expensive step, so that is where a cancel is noticed
+    static const DealerOdds abandoned{};
+    if (shouldStop()) return abandoned;
+
+    scratchGeneration++;
+    scratchUsed = 0;
+    // The dealer has already checked for blackjack, so the hole card can't be the one making it
+    DealerOdds odds = dealerDraw(pointValue(upcard), upcard == 0, 0, naturalHole(upcard));
+    return dealerMemo.emplace(removed, odds).first->second;
+}
+
+// The chance of a run of draws only depends on which cards came out, not their order,
+// so draws are memoized by the dealer's cards rather than walked as sequences.
+// Draws that end the dealer's hand are added in place, only live hands recurse.
+StrategySolver::DealerOdds StrategySolver::dealerDraw(int hardTotal, bool hasAce, std::uint64_t drawn, int excluded) {
+    size_t slot = (drawn * 0x9E3779B97F4A7C15ull) >> (64 - ScratchBits);
+    while (dealerScratch[slot].generation == scratchGeneration) {
+        if (dealerScratch[slot].drawn == drawn) return dealerScratch[slot].odds;
+        slot = (slot + 1) & (ScratchSize - 1);
+    }
+
+    DealerOdds odds{};
+    double cardsLeft = remaining - (excluded >= 0 ? shoe[excluded] : 0);
+    for (int v = 0; v < ValueCount; ++v) {
+        if (shoe[v] == 0 || v == excluded) continue;
+        double p = shoe[v] / cardsLeft;
+
+        int newHard = hardTotal + pointValue(v);
+        bool newAce = hasAce || v == 0;
+        int total = bestTotal(newHard, newAce);
+        bool soft17 = total == 17 && total != newHard;
+        if (newHard > 21) {
+            odds[DealerBust] += p;
+        }
+        else if (!dealerShouldHit(total) && !(rules.dealerHitsSoft17 && soft17)) {
+            odds[total - 17] += p;
+        }
+        else {
+            shoe[v]--;
+            remaining--;
+            DealerOdds next = dealerDraw(newHard, newAce, drawn + keyUnit(v), -1);
+            shoe[v]++;
+            remaining++;
+
+            for (int i = 0; i < DealerBust + 1; ++i) odds[i] += p * next[i];
+        }
+    }
+
+    // Past half full, probing gets long: the rest of these odds are just worked out again
+    if (scratchUsed < ScratchSize / 2) {
+        dealerScratch[slot] = ScratchSlot{ drawn, scratchGeneration, odds };
+        scratchUsed++;
+    }
+    return odds;
+}
+
+double StrategySolver::standEv(int hardTotal, bool hasAce, std::uint64_t removed) {
+    const DealerOdds& odds = dealerOdds(removed);
+    int total = bestTotal(hardTotal, hasAce);
+
+    double ev = odds[DealerBust];
+    for (int dealer = 17; dealer <= 21; ++dealer) {
+        if (total > dealer) ev += odds[dealer - 17];
+        else if (total < dealer) ev -= odds[dealer - 17];
+    }
+    return ev;
+}
+
+double StrategySolver::hitEv(int hardTotal, bool hasAce, std::uint64_t removed, int splitTag) {
+    double ev = 0;
+    double cardsLeft = remaining;
+    for (int v = 0; v < ValueCount; ++v) {
+        if (shoe[v] == 0) continue;
+        double p = shoe[v] / cardsLeft;
+
+        int newTotal = hardTotal + pointValue(v);
+        if (newTotal > 21) {
+            ev -= p;
+            continue;
+        }
+        shoe[v]--;
+        remaining--;
+        ev += p * bestEv(newTotal, hasAce || v == 0, removed + keyUnit(v), splitTag);
+        shoe[v]++;
+        remaining++;
+    }
+    return ev;
+}
+
+double StrategySolver::bestEv(int hardTotal, bool hasAce, std::uint64_t removed, int splitTag) {
+    std::uint64_t key = removed | (std::uint64_t(splitTag) << SplitTagShift);
+    auto found = bestMemo.find(key);
+    if (found != bestMemo.end()) return found->second;
+
+    double ev = standEv(hardTotal, hasAce, removed);
+    if (bestTotal(hardTotal, hasAce) < 21) {
+        ev = std::max(ev, hitEv(hardTotal, hasAce, removed, splitTag));
+    }
+    bestMemo.emplace(key, ev);
+    return ev;
+}
+
+// One card, then stand for twice the bet
+double StrategySolver::doubleEv(int hardTotal, bool hasAce, std::uint64_t removed) {
+    double ev = 0;
+    double cardsLeft = remaining;
+    for (int v = 0; v < ValueCount; ++v) {
+        if (shoe[v] == 0) continue;
+        double p = shoe[v] / cardsLeft;
+
+        int newTotal = hardTotal + pointValue(v);
+        if (newTotal > 21) {
+            ev -= 2 * p;
+            continue;
+        }
+        shoe[v]--;
+        remaining--;
+        ev += 2 * p * standEv(newTotal, hasAce || v == 0, removed + keyUnit(v));
+        shoe[v]++;
+        remaining++;
+    }
+    return ev;
+}
+
+// Both hands of a split play out the same way, so the split is worth twice one of them.
+// Each hand starts from one card of the pair with the other already gone from the shoe,
+// can double after the split where the rules allow it, and split aces get one card only.
+double StrategySolver::splitEv(int value, std::uint64_t removed) {
+    int splitTag = value + 1;
+    double ev = 0;
+    double cardsLeft = remaining;
+    for (int v = 0; v < ValueCount; ++v) {
+        if (shoe[v] == 0) continue;
+        double p = shoe[v] / cardsLeft;
+
+        int hardTotal = pointValue(value) + pointValue(v);
+        bool hasAce = value == 0 || v == 0;
+        shoe[v]--;
+        remaining--;
+        std::uint64_t handRemoved = removed + keyUnit(v);
+        double handEv = standEv(hardTotal, hasAce, handRemoved);
+        if (value != 0) {
+            handEv = std::max(handEv, bestEv(hardTotal, hasAce, handRemoved, splitTag));
+            if (rules.doubleAfterSplit) {
+                handEv = std::max(handEv, doubleEv(hardTotal, hasAce, handRemoved));
+            }
+        }
+        ev += p * handEv;
+        shoe[v]++;
+        remaining++;
+    }
+    return 2 * ev;
+}
+
+StrategyTable::StrategyTable() : decks(0), rules() {
+    Entry stand{ Stand, Stand, {} };
+    for (auto& row : entries) row.fill(stand);
+    upcardEv.fill(0);
+}
+
+void StrategyTable::solve(int deckCount, const RuleConfig& ruleConfig) {
+    decks = std::max(MinDecks, std::min(deckCount, MaxDecks));
+    rules = ruleConfig;
+
+    // Threads take the next upcard until all ten are done, each with its own solver and memo
+    std::atomic<int> nextUpcard(0);
+    auto work = [&]() {
+        for (int upcard = nextUpcard++; upcard < ValueCount; upcard = nextUpcard++) {
+            solveUpcard(upcard);
+        }
+    };
+
+    unsigned threadCount = std::min<unsigned>(ValueCount, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back(work);
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+void StrategyTable::solveUpcard(int upcard) {
+    const ValueCounts fullShoe = shoeCounts(decks);
+    StrategySolver solver(fullShoe, upcard, rules);
+
+    // Hand totals average every two-card hand that makes them, weighted by how often it is dealt
+    std::array<std::array<double, ActionCount>, StrategyRows> sums{};
+    std::array<double, StrategyRows> weights{};
+    double cardsLeft = DeckSize * decks - 1;
+    double roundEv = 0;
+
+    for (int first = 0; first < ValueCount; ++first) {
+        for (int second = first; second < ValueCount; ++second) {
+            int firstCount = fullShoe[first] - (first == upcard);
+            int secondCount = fullShoe[second] - (second == upcard) - (second == first);
+            double weight = (first == second ? 1.0 : 2.0) * firstCount / cardsLeft * secondCount / (cardsLeft - 1);
+            if (weight <= 0) continue;
+
+            ValueCounts hand{};
+            hand[first]++;
+            hand[second]++;
+            bool pair = first == second;
+            HandEv result = solver.evaluate(hand, true, pair);
+
+            // Blackjacks on either side settle before any decision
+            int hole = naturalHole(upcard);
+            double dealerNatural = hole < 0 ? 0.0 : (fullShoe[hole] - (hole == upcard) - hand[hole]) / (cardsLeft - 2);
+            if (first == 0 && second == 9) {
+                roundEv += weight * (1 - dealerNatural) * payoutRatio(rules.payout);
+            }
+            else {
+                roundEv += weight * ((1 - dealerNatural) * result.ev[result.best] - dealerNatural);
+            }
+
+            int hardTotal = pointValue(first) + pointValue(second);
+            int row = first == 0 && hardTotal + 10 <= 21 ? HardRows + hardTotal + 10 - 12 : hardTotal - 4;
+
+            if (pair) {
+                Entry& entry = entries[HardRows + SoftRows + first][upcard];
+                entry.ev = result.ev;
+                entry.firstAction = result.best;
+                entry.laterAction = result.ev[Hit] > result.ev[Stand] ? Hit : Stand;
+
+                // 2-2, T-T and A-A are the only hands making their totals, elsewhere a pair
+                // would skew the total's row with hands that are usually split
+                if (hardTotal != 4 && hardTotal != 20 && first != 0) continue;
+            }
+            for (int a = 0; a < Split; ++a) sums[row][a] += weight * result.ev[a];
+            weights[row] += weight;
+        }
+    }
+
+    for (int row = 0; row < HardRows + SoftRows; ++row) {
+        Entry& entry = entries[row][upcard];
+        entry.ev.fill(NotAllowed);
+        if (weights[row] > 0) {
+            for (int a = 0; a < Split; ++a) entry.ev[a] = sums[row][a] / weights[row];
+        }
+        else {
+            // Hard 21 takes three cards, and with nothing to gain from another card it always stands
+            entry.ev[Stand] = solver.evaluate(ValueCounts{ 1, 0, 0, 0, 0, 0, 0, 0, 0, 2 }, false, false).ev[Stand];
+        }
+        entry.firstAction = bestAction(entry.ev);
+        entry.laterAction = entry.ev[Hit] > entry.ev[Stand] ? Hit : Stand;
+    }
+    upcardEv[upcard] = roundEv;
+}
+
+Action StrategyTable::lookup(const Hand& player, Card dealerUpcard) const {
+    if (player.size() < 2) return Hit;
+    if (player.isBust()) return Stand;
+
+    int upcard = valueIndex(dealerUpcard);
+    bool firstTwo = player.size() == 2;
+    if (firstTwo && valueIndex(player[0]) == valueIndex(player[1])) {
+        const Entry& pair = entries[HardRows + SoftRows + valueIndex(player[0])][upcard];
+        if (pair.firstAction == Split) return Split;
+    }
+
+    int row = player.isSoft() ? HardRows + player.total() - 12 : player.total() - 4;
+    const Entry& entry = entries[row][upcard];
+    return firstTwo ? entry.firstAction : entry.laterAction;
+}
+
+double StrategyTable::expectedValue() const {
+    ValueCounts fullShoe = shoeCounts(decks);
+    double ev = 0;
+    for (int upcard = 0; upcard < ValueCount; ++upcard) {
+        ev += upcardEv[upcard] * fullShoe[upcard] / (DeckSize * decks);
+    }
+    return ev;
+}
+
+// Chart codes: S stand, H hit, P split, Dh double or else hit, Ds double or else stand
+static std::string actionCode(Action first, Action later) {
+    switch (first) {
+    case Stand: return "S";
+    case Hit: return "H";
+    case Split: return "P";
+    default: return later == Hit ? "Dh" : "Ds";
+    }
+}
+
+static std::string rowLabel(int row) {
+    if (row < HardRows) return "H" + std::to_string(row + 4);
+    if (row < HardRows + SoftRows) return "S" + std::to_string(row - HardRows + 12);
+    char value = ValueLabels[row - HardRows - SoftRows];
+    return std::string(1, value) + "," + value;
+}
+
+bool StrategyTable::exportTo(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Error opening " << path << "!" << std::endl;
+        return false;
+    }
+
+    file << "# Basic strategy, " << decks << " deck(s), " << describeRules(rules) << "\n";
+    file << "# S stand, H hit, P split, Dh double else hit, Ds double else stand\n";
+    file << std::left << std::setw(6) << "";
+    for (int column : ChartColumns) file << std::setw(4) << ValueLabels[column];
+    file << "\n";
+    for (int row = 0; row < StrategyRows; ++row) {
+        file << std::setw(6) << rowLabel(row);
+        for (int column : ChartColumns) {
+            const Entry& entry = entries[row][column];
+            file << std::setw(4) << actionCode(entry.firstAction, entry.laterAction);
+        }
+        file << "\n";
+    }
+
+    file << "\n# EV per unit bet for every entry\n";
+    file << std::fixed << std::setprecision(5);
+    for (int row = 0; row < StrategyRows; ++row) {
+        for (int column : ChartColumns) {
+            const Entry& entry = entries[row][column];
+            file << rowLabel(row) << " vs " << ValueLabels[column];
+            for (int a = 0; a < ActionCount; ++a) {
+                if (entry.ev[a] > NotAllowed) file << " " << ActionNames[a] << " " << entry.ev[a];
+            }
+            file << "\n";
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+int exportStrategy(const ShoeConfig& shoeConfig, const RuleConfig& rules, const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+
+    StrategyTable table;
+    table.solve(shoeConfig.decks, rules);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Solved basic strategy for a " << Shoe(shoeConfig).deckCount() << "-deck shoe in "
+        << elapsed.count() << " s" << std::endl;
+    std::cout << "Player EV following the chart: " << 100.0 * table.expectedValue() << "%" << std::endl;
+
+    if (!table.exportTo(path)) {
+        return -1;
+    }
+    std::cout << "Chart written to " << path << std::endl;
+    return 0;
+}
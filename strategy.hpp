@@ -0,0 +1,144 @@
+#pragma once
+
+// Exact blackjack solver: dealer outcome odds and the player's EV for every decision, worked out from
+// the shoe composition, and the basic-strategy chart derived from them.
+// Decisions are taken after the dealer has checked for blackjack, with one split per hand.
+// Surrender is left out of the chart.
+
+#include "engine.hpp"
+#include "rules.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Card values the solver tells apart: ace, 2-9 and the ten-valued cards
+const int ValueCount = 10;
+
+// Cards of each value in a shoe or a hand, indexed by valueIndex
+using ValueCounts = std::array<int, ValueCount>;
+
+// Ace is 0, 2-9 are 1-8, ten-valued cards are 9
+inline int valueIndex(Card card) {
+    return cardValue(card) == AceValue ? 0 : cardValue(card) - 1;
+}
+
+// Cards of each value in a fresh shoe
+ValueCounts shoeCounts(int decks);
+
+// Cards of each value in a hand
+ValueCounts handCounts(const Hand& hand);
+
+enum Action {
+    Stand,
+    Hit,
+    Double,
+    Split,
+    ActionCount
+};
+
+// EV of an action that can't be taken with this hand
+const double NotAllowed = -1000.0;
+
+// Expected win per unit bet for each action, and the action with the highest one
+struct HandEv {
+    std::array<double, ActionCount> ev;
+    Action best;
+};
+
+// Exact EVs against one dealer upcard. Every result is memoized by which cards have left the shoe,
+// so repeated queries are cheap, but a solver belongs to a single thread.
+class StrategySolver {
+public:
+    StrategySolver(const ValueCounts& shoe, int upcard, const RuleConfig& rules);
+
+    // EVs for a hand, drawing from the solver's shoe minus the hand and the upcard
+    HandEv evaluate(const ValueCounts& hand, bool canDouble, bool canSplit);
+
+    // Let another thread stop an evaluation early by raising the flag
+    void setCancelFlag(const std::atomic<bool>* flag);
+
+    // The last evaluation was stopped early: its EVs, and everything memoized since, are garbage
+    // and the solver has to be thrown away
+    bool interrupted() const;
+
+private:
+    // Chance of the dealer finishing on 17, 18, 19, 20, 21, or busting
+    using DealerOdds = std::array<double, 6>;
+
+    const DealerOdds& dealerOdds(std::uint64_t removed);
+    DealerOdds dealerDraw(int hardTotal, bool hasAce, std::uint64_t drawn, int excluded);
+
+    double standEv(int hardTotal, bool hasAce, std::uint64_t removed);
+    double hitEv(int hardTotal, bool hasAce, std::uint64_t removed, int splitTag);
+    double bestEv(int hardTotal, bool hasAce, std::uint64_t removed, int splitTag);
+    double doubleEv(int hardTotal, bool hasAce, std::uint64_t removed);
+    double splitEv(int value, std::uint64_t removed);
+
+    bool shouldStop();
+
+    ValueCounts shoe; // What is left to draw at the current point of the recursion
+    int remaining;
+    int upcard;
+    RuleConfig rules;
+    const std::atomic<bool>* cancelFlag;
+    bool stopped;
+
+    // Keyed by the cards that left the shoe besides the upcard, 5 bits per value
+    std::unordered_map<std::uint64_t, DealerOdds> dealerMemo;
+    std::unordered_map<std::uint64_t, double> bestMemo;
+
+    // Dealer draws of the odds being worked out, keyed by the cards the dealer drew. Open addressing
+    // with a generation stamp, so moving on to the next odds is a counter bump instead of a clear.
+    struct ScratchSlot {
+        std::uint64_t drawn;
+        std::uint32_t generation;
+        DealerOdds odds;
+    };
+    std::vector<ScratchSlot> dealerScratch;
+    std::uint32_t scratchGeneration;
+    int scratchUsed;
+};
+
+// Hard 4-21, soft 12-21, then one row per pair
+const int HardRows = 18;
+const int SoftRows = 10;
+const int StrategyRows = HardRows + SoftRows + ValueCount;
+
+// Basic-strategy chart for a shoe: the best action for every hand against every upcard.
+// Lookups are two array indexes, so it can be consulted for every decision.
+class StrategyTable {
+public:
+    StrategyTable();
+
+    // Work out the whole chart for a fresh shoe, one upcard per thread
+    void solve(int decks, const RuleConfig& rules);
+
+    // Best action for a hand. Doubling and splitting only ever come back for the first two cards.
+    Action lookup(const Hand& player, Card dealerUpcard) const;
+
+    // Player's EV per round when every hand follows the chart
+    double expectedValue() const;
+
+    // Write the chart and the EVs behind each entry as text
+    bool exportTo(const std::string& path) const;
+
+private:
+    struct Entry {
+        Action firstAction; // With the first two cards
+        Action laterAction; // Once a card has been hit, only Hit or Stand
+        std::array<double, ActionCount> ev;
+    };
+
+    void solveUpcard(int upcard);
+
+    std::array<std::array<Entry, ValueCount>, StrategyRows> entries;
+    std::array<double, ValueCount> upcardEv;
+    int decks;
+    RuleConfig rules;
+};
+
+// Solve the chart for the configured shoe, print how long it took and write it to a file
+int exportStrategy(const ShoeConfig& shoeConfig, const RuleConfig& rules, const std::string& path);
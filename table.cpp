@@ -0,0 +1,118 @@
+#include "table.hpp"
+
+Table::Table(const ShoeConfig& shoeConfig, const RuleConfig& ruleConfig, std::uint64_t seed, std::uint64_t stream)
+    : rng(seed, stream), shoe(shoeConfig), config(ruleConfig), rules(makeTableRules(ruleConfig)), seed(seed), stream(stream),
+      rounds(0), shuffles(0), shoePosition(0), log(nullptr), nextStacked(0),
+      currentState(WaitingForDeal), lastResult{ Tie, 0.0 } {
+    shoe.shuffle(rng);
+}
+
+bool Table::deal() {
+    if (currentState == PlayerTurn) return false;
+
+    dealerCards.clear();
+    playerCards.clear();
+
+    // The shoe is kept between rounds and only reshuffled once the cut card comes out.
+    // A stacked round leaves the shoe alone.
+    if (nextStacked >= stacked.size() && shoe.needsShuffle()) {
+        shoe.shuffle(rng);
+        shuffles++;
+    }
+    shoePosition = static_cast<std::uint16_t>(shoe.deckCount() * DeckSize - shoe.remaining());
+    shoe.beginRound();
+
+    // Deal initial cards in table order
+    dealerCards.add(draw());
+    dealerCards.add(draw());
+    playerCards.add(draw());
+    playerCards.add(draw());
+    currentState = PlayerTurn;
+
+    // A blackjack on either side settles the round on the spot
+    if (isNatural(dealerCards) || isNatural(playerCards)) {
+        finishRound(rules.settle(dealerCards, playerCards));
+    }
+    return true;
+}
+
+bool Table::hit() {
+    if (currentState != PlayerTurn) return false;
+
+    playerCards.add(draw());
+    if (playerCards.isBust()) {
+        finishRound(RoundResult{ DealerWins, -1.0 });
+    }
+    return true;
+}
+
+bool Table::stand() {
+    if (currentState != PlayerTurn) return false;
+
+    while (rules.dealerShouldHit(dealerCards)) {
+        dealerCards.add(draw());
+    }
+    finishRound(rules.settle(dealerCards, playerCards));
+    return true;
+}
+
+TableState Table::state() const {
+    return currentState;
+}
+
+const Hand& Table::dealerHand() const {
+    return dealerCards;
+}
+
+const Hand& Table::playerHand() const {
+    return playerCards;
+}
+
+const RoundResult& Table::result() const {
+    return lastResult;
+}
+
+void Table::setLog(HandLogWriter* handLog) {
+    log = handLog;
+}
+
+void Table::setRules(const RuleConfig& ruleConfig) {
+    if (currentState == PlayerTurn) return;
+    config = ruleConfig;
+    rules = makeTableRules(ruleConfig);
+}
+
+const RuleConfig& Table::ruleConfig() const {
+    return config;
+}
+
+void Table::stackCards(const std::vector<Card>& cards) {
+    stacked = cards;
+    nextStacked = 0;
+}
+
+Card Table::draw() {
+    if (nextStacked < stacked.size()) return stacked[nextStacked++];
+
+    // Running out mid-round shuffles the discards back in, which counts as a shuffle for later rounds
+    if (shoe.empty()) shuffles++;
+    return shoe.deal(rng);
+}
+
+void Table::finishRound(const RoundResult& roundResult) {
+    lastResult = roundResult;
+    currentState = RoundOver;
+
+    if (log) {
+        HandRecord record = makeHandRecord(dealerCards, playerCards, roundResult.outcome, roundResult.payout);
+        record.seed = seed;
+        record.stream = static_cast<std::uint32_t>(stream);
+        record.round = rounds;
+        record.shuffle = shuffles;
+        record.shoePosition = shoePosition;
+        record.decks = static_cast<std::uint8_t>(shoe.deckCount());
+        record.rules = packRules(config);
+        log->append(record);
+    }
+    rounds++;
+}
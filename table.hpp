@@ -0,0 +1,70 @@
+#pragma once
+
+// One blackjack table: its own shoe, hands and round state. The GUI plays a single table,
+// the headless server runs thousands of them side by side.
+
+#include "engine.hpp"
+#include "hand_log.hpp"
+#include "rng.hpp"
+#include "rules.hpp"
+#include <cstdint>
+#include <vector>
+
+enum TableState {
+    WaitingForDeal,
+    PlayerTurn,
+    RoundOver
+};
+
+class Table {
+public:
+    // Tables sharing a seed but not a stream deal independent shoes
+    Table(const ShoeConfig& shoeConfig, const RuleConfig& rules, std::uint64_t seed, std::uint64_t stream = 0);
+
+    // Start a new round, reshuffling first once the cut card has come out.
+    // Blackjack on either side ends the round straight away.
+    bool deal();
+
+    // Player actions, false when they can't be taken right now
+    bool hit();
+    bool stand();
+
+    TableState state() const;
+    const Hand& dealerHand() const;
+    const Hand& playerHand() const;
+
+    // How the last round ended, only meaningful once it is over
+    const RoundResult& result() const;
+
+    // Record every finished round to a hand log, or stop with nullptr. The log must outlive the table.
+    void setLog(HandLogWriter* log);
+
+    // Play the following rounds under other rules, e.g. those a replayed round was recorded under.
+    // Ignored in the middle of a round.
+    void setRules(const RuleConfig& rules);
+    const RuleConfig& ruleConfig() const;
+
+    // Deal these cards, in order, ahead of the shoe. Replays a recorded round when given its dealOrder.
+    void stackCards(const std::vector<Card>& cards);
+
+private:
+    Card draw();
+    void finishRound(const RoundResult& roundResult);
+
+    Rng rng;
+    Shoe shoe;
+    RuleConfig config;
+    TableRules rules;
+    std::uint64_t seed;
+    std::uint64_t stream;
+    std::uint32_t rounds;
+    std::uint16_t shuffles;
+    std::uint16_t shoePosition; // Cards out of the shoe when the round was dealt
+    HandLogWriter* log;
+    std::vector<Card> stacked;
+    size_t nextStacked;
+    Hand dealerCards;
+    Hand playerCards;
+    TableState currentState;
+    RoundResult lastResult;
+};
@@ -0,0 +1,64 @@
+#include "texture_cache.hpp"
+#include <iostream>
+
+TextureCache::TextureCache(size_t budgetBytes, const sf::Vector2u& maxSize)
+    : budget(budgetBytes), maxSize(maxSize), resident(0) {
+}
+
+const sf::Texture* TextureCache::get(const std::string& path) {
+    auto found = index.find(path);
+    if (found != index.end()) {
+        entries.splice(entries.begin(), entries, found->second);
+        return entries.front().texture.get();
+    }
+    if (failed.count(path)) {
+        return nullptr;
+    }
+
+    // A prefetch has usually finished decoding by now, otherwise wait for it or decode right here
+    auto decoding = pending.find(path);
+    sf::Image image;
+    if (decoding != pending.end()) {
+        image = decoding->second.get();
+        pending.erase(decoding);
+    }
+    else {
+        image = decodeImageAsync(path, maxSize).get();
+    }
+    if (image.getSize().x == 0) {
+        failed.insert(path); // Already reported
+        return nullptr;
+    }
+
+    auto texture = std::make_unique<sf::Texture>();
+    if (!texture->loadFromImage(image)) {
+        std::cerr << "Error creating texture for " << path << "!" << std::endl;
+        failed.insert(path);
+        return nullptr;
+    }
+    texture->setSmooth(true);
+
+    size_t bytes = static_cast<size_t>(image.getSize().x) * image.getSize().y * 4;
+    entries.push_front(Entry{ path, std::move(texture), bytes });
+    index[path] = entries.begin();
+    resident += bytes;
+    evictToBudget();
+    return entries.front().texture.get();
+}
+
+void TextureCache::prefetch(const std::string& path) {
+    if (index.count(path) || pending.count(path) || failed.count(path)) return;
+    pending.emplace(path, decodeImageAsync(path, maxSize));
+}
+
+size_t TextureCache::residentBytes() const {
+    return resident;
+}
+
+void TextureCache::evictToBudget() {
+    while (resident > budget && entries.size() > 1) {
+        resident -= entries.back().bytes;
+        index.erase(entries.back().path);
+        entries.pop_back();
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Cosmetic textures loaded on demand by path and kept within a video memory budget. The least recently
+// used ones are evicted first, and the next one the player is likely to ask for can be decoded ahead of
+// time on a worker, so adding content costs neither startup time nor resident memory.
+
+#include <SFML/Graphics.hpp>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "assets.hpp"
+
+class TextureCache {
+public:
+    // Images bigger than maxSize are shrunk to fit it when they are decoded
+    TextureCache(size_t budgetBytes, const sf::Vector2u& maxSize);
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // Texture for an image file, decoded and uploaded on first use, or null if it can't be loaded.
+    // A file that fails is reported once and not tried again.
+    // Must run on the GL thread. A texture stays valid until a later get evicts it, and the one
+    // returned last is never evicted, so callers hold on to the current one and fetch again on a change.
+    const sf::Texture* get(const std::string& path);
+
+    // Start decoding an image on a worker, so a later get only has to upload it
+    void prefetch(const std::string& path);
+
+    // Video memory taken by the textures in the cache
+    size_t residentBytes() const;
+
+private:
+    struct Entry {
+        std::string path;
+        std::unique_ptr<sf::Texture> texture;
+        size_t bytes;
+    };
+
+    void evictToBudget();
+
+    size_t budget;
+    sf::Vector2u maxSize;
+    size_t resident;
+
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::unordered_map<std::string, DecodedImage> pending; // Prefetches still decoding or not yet asked for
+    std::unordered_set<std::string> failed; // Files that couldn't be loaded, kept apart so eviction never forgets them
+};
@@ -0,0 +1,92 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+// Which pool the current thread works for, and its queue there
+static thread_local const WorkStealingPool* currentPool = nullptr;
+static thread_local int currentIndex = -1;
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+    : nextQueue(0), pending(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void WorkStealingPool::submit(Task task) {
+    int worker = currentWorker();
+    unsigned index = worker >= 0 ? static_cast<unsigned>(worker) : nextQueue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    pending++;
+
+    // Taking the sleep lock orders this with a worker that has just checked for work and is about to wait
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wake.notify_one();
+}
+
+unsigned WorkStealingPool::threadCount() const {
+    return static_cast<unsigned>(workers.size());
+}
+
+int WorkStealingPool::currentWorker() const {
+    return currentPool == this ? currentIndex : -1;
+}
+
+bool WorkStealingPool::popLocal(unsigned index, Task& task) {
+    WorkQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned thief, Task& task) {
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& queue = *queues[(thief + offset) % queues.size()];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned index) {
+    currentPool = this;
+    currentIndex = static_cast<int>(index);
+
+    Task task;
+    while (true) {
+        if (popLocal(index, task) || steal(index, task)) {
+            pending--;
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        // A steal can miss a queue that was busy, so only sleep once nothing is pending at all.
+        // Whatever was queued before the pool is destroyed still runs.
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return stopping || pending > 0; });
+        if (stopping && pending <= 0) break;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Work-stealing thread pool for short tasks. Each worker has its own queue and runs its newest
+// task first, idle workers take the oldest task from someone else's queue.
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // No thread count means one worker per core
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    // Runs everything still queued, then joins the workers
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queue a task. From a worker it goes on that worker's own queue, from anywhere else
+    // the queues take turns.
+    void submit(Task task);
+
+    unsigned threadCount() const;
+
+    // Index of the calling worker, or -1 off the pool
+    int currentWorker() const;
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popLocal(unsigned index, Task& task);
+    bool steal(unsigned thief, Task& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue;
+    std::atomic<long long> pending; // Queued but not yet picked up
+    std::atomic<bool> stopping;
+
+    // Idle workers sleep here until something is queued
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+};
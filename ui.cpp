@@ -0,0 +1,250 @@
+#include "ui.hpp"
+
+const sf::Color StartButtonColor(0, 0, 0, 200); // Black with 200 alpha for transparency
+const sf::Color StartButtonHoverColor(50, 50, 50, 255); // Slightly darker on hover
+const sf::Color FeltColor(0, 96, 100);
+
+Button::Button(const std::string& label, const sf::Font& font, unsigned characterSize,
+    const sf::Color& fillColor, const sf::Color& textColor, float textLift)
+    : text(label, font, characterSize), textLift(textLift) {
+    shape.setFillColor(fillColor);
+    text.setFillColor(textColor);
+}
+
+void Button::setLayout(const sf::Vector2f& position, const sf::Vector2f& size) {
+    shape.setSize(size);
+    shape.setPosition(position);
+
+    sf::FloatRect textBounds = text.getLocalBounds();
+    text.setPosition(position.x + (size.x - textBounds.width) / 2,
+        position.y + (size.y - textBounds.height) / 2 - textLift);
+}
+
+void Button::setFillColor(const sf::Color& color) {
+    if (shape.getFillColor() != color) {
+        shape.setFillColor(color);
+    }
+}
+
+sf::RectangleShape& Button::getShape() {
+    return shape;
+}
+
+sf::Text& Button::getText() {
+    return text;
+}
+
+sf::FloatRect Button::getBounds() const {
+    return sf::FloatRect(shape.getPosition(), shape.getSize());
+}
+
+void Button::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(shape, states);
+    target.draw(text, states);
+}
+
+ValueText::ValueText(const std::string& prefix, const sf::Font& font, unsigned characterSize)
+    : text(prefix, font, characterSize), prefix(prefix), value(0), hasValue(false) {
+    text.setFillColor(sf::Color::White);
+}
+
+void ValueText::setValue(int newValue) {
+    if (hasValue && value == newValue) return;
+    value = newValue;
+    hasValue = true;
+    text.setString(prefix + std::to_string(value));
+}
+
+void ValueText::setPosition(const sf::Vector2f& position) {
+    text.setPosition(position);
+}
+
+void ValueText::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(text, states);
+}
+
+TableUi::TableUi(const sf::Font& font)
+    : startButton("Start", font, 40, StartButtonColor, sf::Color::White, 10),
+      dealerText("DEALER", font, 40),
+      playerText("PLAYER", font, 40),
+      dealerSum("Sum: ", font, 50),
+      playerSum("Sum: ", font, 50),
+      resultText("", font, 50),
+      hintText("", font, 30),
+      hitButton("Hit", font, 40, sf::Color(0, 255, 0), sf::Color::Black, 10),
+      standButton("Stand", font, 40, sf::Color(255, 0, 0), sf::Color::Black, 10),
+      restartButton("Restart", font, 40, sf::Color(255, 255, 0), sf::Color::Black, 10),
+      pauseButton("Pause", font, 30, sf::Color(100, 100, 100, 200), sf::Color::White, 5),
+      pausedText("Paused", font, 50),
+      resumeButton("Resume", font, 30, sf::Color(100, 200, 100), sf::Color::Black, 5),
+      quitButton("Quit", font, 30, sf::Color(200, 100, 100), sf::Color::Black, 5),
+      hovered(NoButton) {
+    startButton.getShape().setOutlineColor(sf::Color(255, 255, 255, 150)); // White outline with slight transparency
+    startButton.getShape().setOutlineThickness(3);
+    startButton.getText().setStyle(sf::Text::Bold);
+
+    table.setFillColor(FeltColor); // Green table
+    dealerZone.setFillColor(sf::Color(0, 0, 0, 50)); // Semi-transparent black
+    playerZone.setFillColor(sf::Color(0, 0, 0, 50));
+    dealerText.setFillColor(sf::Color::White);
+    playerText.setFillColor(sf::Color::White);
+
+    resultText.setFillColor(sf::Color::White);
+    resultText.setStyle(sf::Text::Bold);
+    hintText.setFillColor(sf::Color(255, 255, 255, 200));
+
+    overlay.setFillColor(sf::Color(0, 0, 0, 200));
+    pausedText.setFillColor(sf::Color::White);
+    pausedText.setStyle(sf::Text::Bold);
+
+    buttons[StartButton] = &startButton;
+    buttons[HitButton] = &hitButton;
+    buttons[StandButton] = &standButton;
+    buttons[RestartButton] = &restartButton;
+    buttons[PauseButton] = &pauseButton;
+    buttons[ResumeButton] = &resumeButton;
+    buttons[QuitButton] = &quitButton;
+
+    layers[StartLayer] = { StartButton };
+    layers[PlayLayer] = { HitButton, StandButton, PauseButton };
+    layers[RoundOverLayer] = { RestartButton, PauseButton };
+    layers[PauseLayer] = { ResumeButton, QuitButton };
+}
+
+void TableUi::setBackground(const sf::Texture& texture) {
+    background.setTexture(texture, true);
+    layout(tableSize);
+}
+
+void TableUi::setTableSkin(const sf::Texture* texture) {
+    // A skin is drawn untinted, stretched over the whole table
+    table.setTexture(texture, true);
+    table.setFillColor(texture ? sf::Color::White : FeltColor);
+}
+
+void TableUi::layout(const sf::Vector2u& size) {
+    tableSize = size;
+    float width = static_cast<float>(size.x);
+    float height = static_cast<float>(size.y);
+
+    // Start screen
+    if (background.getTexture()) {
+        sf::Vector2u textureSize = background.getTexture()->getSize();
+        background.setScale(width / textureSize.x, height / textureSize.y);
+    }
+    startButton.setLayout(sf::Vector2f((width - 250) / 2, 800), sf::Vector2f(250, 80));
+
+    // Table
+    table.setSize(sf::Vector2f(width, height));
+    dealerZone.setSize(sf::Vector2f(width * 0.9f, height * 0.1f));
+    dealerZone.setPosition(width * 0.05f, height * 0.05f);
+    playerZone.setSize(sf::Vector2f(width * 0.9f, height * 0.1f));
+    playerZone.setPosition(width * 0.05f, height * 0.85f);
+    dealerText.setPosition(width * 0.45f, height * 0.055f);
+    dealerSum.setPosition(sf::Vector2f(width * 0.05f, height * 0.16f)); // Slightly below dealer zone
+    playerText.setPosition(width * 0.45f, height * 0.86f);
+    playerSum.setPosition(sf::Vector2f(width * 0.05f, height * 0.77f)); // Above player zone
+
+    // Buttons
+    sf::Vector2f buttonSize(width * 0.1f, height * 0.08f);
+    float buttonY = height * 0.7f; // Vertical position for buttons
+    float leftOffset = width * 0.2f; // Distance from the left side of the screen
+    float spacing = width * 0.02f;   // Spacing between buttons
+    hitButton.setLayout(sf::Vector2f(leftOffset, buttonY), buttonSize);
+    standButton.setLayout(sf::Vector2f(leftOffset + buttonSize.x + spacing, buttonY), buttonSize);
+    restartButton.setLayout(sf::Vector2f(leftOffset, buttonY), buttonSize);
+    pauseButton.setLayout(sf::Vector2f(width - 120, 20), sf::Vector2f(100, 50)); // Top-right corner
+
+    // Result text is centred again whenever the message changes
+    sf::FloatRect resultBounds = resultText.getLocalBounds();
+    resultText.setPosition((width - resultBounds.width) / 2, (height - resultBounds.height) / 2);
+
+    // Strategy hint sits right of the action buttons
+    hintText.setPosition(width * 0.65f, height * 0.72f);
+
+    // Pause menu
+    overlay.setSize(sf::Vector2f(width, height));
+    sf::FloatRect pausedBounds = pausedText.getLocalBounds();
+    pausedText.setPosition((width - pausedBounds.width) / 2, (height - pausedBounds.height) / 2 - 100);
+    resumeButton.setLayout(sf::Vector2f((width - 200) / 2, (height - 50) / 2 - 30), sf::Vector2f(200, 50));
+    quitButton.setLayout(sf::Vector2f((width - 200) / 2, (height - 50) / 2 + 50), sf::Vector2f(200, 50));
+}
+
+void TableUi::setSums(int dealerValue, int playerValue) {
+    dealerSum.setValue(dealerValue);
+    playerSum.setValue(playerValue);
+}
+
+void TableUi::setResult(const std::string& message) {
+    if (message == resultMessage) return;
+    resultMessage = message;
+    resultText.setString(message);
+
+    sf::FloatRect bounds = resultText.getLocalBounds();
+    resultText.setPosition((tableSize.x - bounds.width) / 2, (tableSize.y - bounds.height) / 2);
+}
+
+bool TableUi::setHint(const std::string& message) {
+    if (message == hintMessage) return false;
+    hintMessage = message;
+    hintText.setString(message);
+    return true;
+}
+
+ButtonId TableUi::hitTest(UiLayer layer, const sf::Vector2f& point) const {
+    for (ButtonId id : layers[layer]) {
+        if (buttons[id]->getBounds().contains(point)) {
+            return id;
+        }
+    }
+    return NoButton;
+}
+
+bool TableUi::setHovered(ButtonId button) {
+    if (button == hovered) return false;
+
+    // Only the start button has a hover look
+    bool redraw = button == StartButton || hovered == StartButton;
+    hovered = button;
+    startButton.setFillColor(hovered == StartButton ? StartButtonHoverColor : StartButtonColor);
+    return redraw;
+}
+
+void TableUi::drawStartScreen(sf::RenderTarget& target) const {
+    target.draw(background);
+    drawButtons(target, StartLayer);
+}
+
+void TableUi::drawTable(sf::RenderTarget& target) const {
+    target.draw(table);
+    target.draw(dealerZone);
+    target.draw(playerZone);
+    target.draw(dealerText);
+    target.draw(dealerSum);
+    target.draw(playerText);
+    target.draw(playerSum);
+}
+
+void TableUi::drawButtons(sf::RenderTarget& target, UiLayer layer) const {
+    for (ButtonId id : layers[layer]) {
+        target.draw(*buttons[id]);
+    }
+}
+
+void TableUi::drawResult(sf::RenderTarget& target) const {
+    if (!resultMessage.empty()) {
+        target.draw(resultText);
+    }
+}
+
+void TableUi::drawHint(sf::RenderTarget& target) const {
+    if (!hintMessage.empty()) {
+        target.draw(hintText);
+    }
+}
+
+void TableUi::drawPauseMenu(sf::RenderTarget& target) const {
+    target.draw(overlay);
+    target.draw(pausedText);
+    drawButtons(target, PauseLayer);
+}
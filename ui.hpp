@@ -0,0 +1,147 @@
+#pragma once
+
+// Retained-mode UI: every shape and text on screen is built once and laid out once, in the virtual table
+// space. A resize only changes the viewport and render scale it is drawn with. During play only the
+// values that actually change are touched.
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+// Every clickable widget, the same ids are used to draw them and to find them under the mouse
+enum ButtonId {
+    NoButton = -1,
+    StartButton,
+    HitButton,
+    StandButton,
+    RestartButton,
+    PauseButton,
+    ResumeButton,
+    QuitButton,
+    ButtonCount
+};
+
+// Buttons that are on screen together
+enum UiLayer {
+    StartLayer,     // Start screen
+    PlayLayer,      // Hit, Stand and Pause while a round is in play
+    RoundOverLayer, // Restart and Pause once the round is decided
+    PauseLayer,     // Resume and Quit over the pause overlay
+    LayerCount
+};
+
+// A filled rectangle with a centred label
+class Button : public sf::Drawable {
+public:
+    Button(const std::string& label, const sf::Font& font, unsigned characterSize,
+        const sf::Color& fillColor, const sf::Color& textColor, float textLift);
+
+    void setLayout(const sf::Vector2f& position, const sf::Vector2f& size);
+
+    // Only touches the shape when the colour is different
+    void setFillColor(const sf::Color& color);
+
+    sf::RectangleShape& getShape();
+    sf::Text& getText();
+    sf::FloatRect getBounds() const;
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    sf::RectangleShape shape;
+    sf::Text text;
+    float textLift; // Glyph bounds sit low in the line, so the label is nudged up to look centred
+};
+
+// "Sum: 17" style text that only rebuilds its string when the number changes
+class ValueText : public sf::Drawable {
+public:
+    ValueText(const std::string& prefix, const sf::Font& font, unsigned characterSize);
+
+    void setValue(int newValue);
+    void setPosition(const sf::Vector2f& position);
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    sf::Text text;
+    std::string prefix;
+    int value;
+    bool hasValue;
+};
+
+// Every widget of the start screen, the table and the pause menu
+class TableUi {
+public:
+    explicit TableUi(const sf::Font& font);
+
+    // The button registry points into this object
+    TableUi(const TableUi&) = delete;
+    TableUi& operator=(const TableUi&) = delete;
+
+    void setBackground(const sf::Texture& texture);
+
+    // Cover the table with a skin, or go back to the plain felt with null
+    void setTableSkin(const sf::Texture* texture);
+
+    // Position everything on a table of this size, VirtualSize whatever the window. Called once at startup.
+    void layout(const sf::Vector2u& tableSize);
+
+    // Values that change during play, each one only rebuilds its own widget when it differs
+    void setSums(int dealerSum, int playerSum);
+    void setResult(const std::string& message);
+    bool setHint(const std::string& message); // True when the hint has to be redrawn
+
+    // Button under a point among the ones on screen in a layer, NoButton when there is none.
+    // Uses the bounds the buttons are drawn with, so input always matches what is shown.
+    ButtonId hitTest(UiLayer layer, const sf::Vector2f& point) const;
+
+    // Highlight the button under the mouse, true when the screen has to be redrawn
+    bool setHovered(ButtonId button);
+
+    void drawStartScreen(sf::RenderTarget& target) const;
+    void drawTable(sf::RenderTarget& target) const;
+    void drawButtons(sf::RenderTarget& target, UiLayer layer) const;
+    void drawResult(sf::RenderTarget& target) const;
+    void drawHint(sf::RenderTarget& target) const;
+    void drawPauseMenu(sf::RenderTarget& target) const;
+
+private:
+    sf::Vector2u tableSize;
+
+    // Start screen
+    sf::Sprite background;
+    Button startButton;
+
+    // Table
+    sf::RectangleShape table;
+    sf::RectangleShape dealerZone;
+    sf::RectangleShape playerZone;
+    sf::Text dealerText;
+    sf::Text playerText;
+    ValueText dealerSum;
+    ValueText playerSum;
+    sf::Text resultText;
+    std::string resultMessage;
+    sf::Text hintText;
+    std::string hintMessage;
+
+    // Buttons
+    Button hitButton;
+    Button standButton;
+    Button restartButton;
+    Button pauseButton;
+
+    // Pause menu
+    sf::RectangleShape overlay;
+    sf::Text pausedText;
+    Button resumeButton;
+    Button quitButton;
+
+    // Button registry: each id points at its widget, and each layer lists the ids it shows.
+    // No layer holds more than three buttons, so a scan is as fast as any index.
+    std::array<const Button*, ButtonCount> buttons;
+    std::array<std::vector<ButtonId>, LayerCount> layers;
+    ButtonId hovered;
+};